@@ -2,12 +2,13 @@
 
 #include <cctype>
 #include <ranges>
+#include <span>
 #include <tuple>
-#include <unordered_map>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "memoize.h"
 #include "tokenize.h"
 
 enum class SpringState
@@ -84,13 +85,18 @@ int main(int argc, char** argv)
 
     const std::vector map{ file_data | lines | to_string_views | split_lines | to_map | to_vector };
 
-    size_t number_configuration{ 0 };
-    for (const auto& map_line : map)
+    // Every map passed down is a suffix of the line, or such a suffix with its leading '?' replaced by '#'. So
+    // its size, the number of ranges left and whether it starts with '#' are enough to tell them apart
+    static constexpr auto to_memo_key = [](size_t num_ranges, std::string_view map, std::span<const size_t> ranges)
     {
-        fmt::print("{}\n", map_line.DirectMap);
-        const auto num_legal = [&](this const auto& self,
-                                   std::string_view map,
-                                   std::span<const size_t> ranges) -> size_t
+        return (map.size() * (num_ranges + 1) + ranges.size()) * 2 + (map.starts_with('#') ? 1 : 0);
+    };
+
+    auto num_legal{ algo::memoize(
+        [](this const auto& self,
+           size_t num_ranges,
+           std::string_view map,
+           std::span<const size_t> ranges) -> size_t
         {
             map = algo::trim(map, '.');
 
@@ -127,20 +133,29 @@ int main(int argc, char** argv)
                 else
                 {
                     // ranges.front() + 1 to skip the separating '.'
-                    result = self(map.substr(ranges.front() + 1), ranges.subspan(1));
+                    result = self(num_ranges, map.substr(ranges.front() + 1), ranges.subspan(1));
                 }
             }
             else if (map.starts_with('?'))
             {
                 // replace for '?' once with '.' (omitted) and once with '#'
-                result = self(map.substr(1), ranges) +
-                         self('#' + std::string{ map.substr(1) }, ranges);
+                result = self(num_ranges, map.substr(1), ranges) +
+                         self(num_ranges, '#' + std::string{ map.substr(1) }, ranges);
             }
 
             return result;
-        };
+        },
+        to_memo_key,
+        MemoArray<size_t>{}) };
 
-        const size_t result{ num_legal(map_line.DirectMap, map_line.RangeMap) };
+    size_t number_configuration{ 0 };
+    for (const auto& map_line : map)
+    {
+        const size_t num_ranges{ map_line.RangeMap.size() };
+        num_legal.storage().reset((map_line.DirectMap.size() + 1) * (num_ranges + 1) * 2);
+
+        fmt::print("{}\n", map_line.DirectMap);
+        const size_t result{ num_legal(num_ranges, map_line.DirectMap, map_line.RangeMap) };
         fmt::print("\t{}\n", result);
         number_configuration += result;
     }
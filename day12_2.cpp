@@ -2,12 +2,12 @@
 
 #include <cctype>
 #include <ranges>
-#include <tuple>
-#include <unordered_map>
+#include <span>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "memoize.h"
 #include "tokenize.h"
 
 enum class SpringState
@@ -23,55 +23,6 @@ struct BrokenSpringMap
     std::vector<size_t> RangeMap;
 };
 
-using MemoizationRangesContainer = std::span<const size_t>;
-using MemoizationKey = std::pair<std::string, MemoizationRangesContainer>;
-
-template<class T>
-struct std::hash<std::span<const T>>
-{
-    std::size_t operator()(const std::span<const T>& s) const noexcept
-    {
-        size_t seed = 0;
-        std::hash<T> hasher{};
-        for (const T& i : s)
-        {
-            seed ^= hasher(i) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
-    }
-};
-template<>
-struct std::hash<MemoizationKey>
-{
-    std::size_t operator()(const MemoizationKey& m) const noexcept
-    {
-        size_t seed = 0;
-        seed ^= std::hash<std::string>{}(m.first) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<MemoizationRangesContainer>{}(m.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        return seed;
-    }
-};
-
-template<class T>
-struct std::equal_to<std::span<T>>
-{
-    bool operator()(const std::span<T>& lhs, const std::span<T>& rhs) const noexcept
-    {
-        return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size_bytes()) == 0;
-    }
-};
-template<>
-struct std::equal_to<MemoizationKey>
-{
-    bool operator()(const MemoizationKey& lhs, const MemoizationKey& rhs) const noexcept
-    {
-        return std::equal_to<std::string>{}(lhs.first, rhs.first) &&
-               std::equal_to<MemoizationRangesContainer>{}(lhs.second, rhs.second);
-    }
-};
-
-using MemoizeMap = std::unordered_map<MemoizationKey, size_t>;
-
 int main(int argc, char** argv)
 {
     if (argc != 2)
@@ -146,15 +97,18 @@ int main(int argc, char** argv)
 
     const std::vector map{ file_data | lines | to_string_views | split_lines | to_map | to_vector };
 
-    size_t number_configuration{ 0 };
-    for (const auto& map_line : map)
+    // Every map passed down is a suffix of the line, or such a suffix with its leading '?' replaced by '#'. So
+    // its size, the number of ranges left and whether it starts with '#' are enough to tell them apart
+    static constexpr auto to_memo_key = [](size_t num_ranges, std::string_view map, std::span<const size_t> ranges)
     {
-        MemoizeMap memoize;
+        return (map.size() * (num_ranges + 1) + ranges.size()) * 2 + (map.starts_with('#') ? 1 : 0);
+    };
 
-        fmt::print("{}\n", map_line.DirectMap);
-        const auto num_legal = [&](this const auto& self,
-                                   std::string_view map,
-                                   std::span<const size_t> ranges) -> size_t
+    auto num_legal{ algo::memoize(
+        [](this const auto& self,
+           size_t num_ranges,
+           std::string_view map,
+           std::span<const size_t> ranges) -> size_t
         {
             map = algo::trim(map, '.');
 
@@ -168,13 +122,6 @@ int main(int argc, char** argv)
                 return algo::contains(map, '#') ? 0 : 1;
             }
 
-            MemoizationKey memo_key{ std::string{ map }, ranges };
-            auto memo_it{ memoize.find(memo_key) };
-            if (memo_it != memoize.end())
-            {
-                return memo_it->second;
-            }
-
             size_t result{};
             if (map.starts_with('#'))
             {
@@ -198,21 +145,29 @@ int main(int argc, char** argv)
                 else
                 {
                     // ranges.front() + 1 to skip the separating '.'
-                    result = self(map.substr(ranges.front() + 1), ranges.subspan(1));
+                    result = self(num_ranges, map.substr(ranges.front() + 1), ranges.subspan(1));
                 }
             }
             else if (map.starts_with('?'))
             {
                 // replace for '?' once with '.' (omitted) and once with '#'
-                result = self(map.substr(1), ranges) +
-                         self('#' + std::string{ map.substr(1) }, ranges);
+                result = self(num_ranges, map.substr(1), ranges) +
+                         self(num_ranges, '#' + std::string{ map.substr(1) }, ranges);
             }
 
-            memoize[std::move(memo_key)] = result;
             return result;
-        };
+        },
+        to_memo_key,
+        MemoArray<size_t>{}) };
+
+    size_t number_configuration{ 0 };
+    for (const auto& map_line : map)
+    {
+        const size_t num_ranges{ map_line.RangeMap.size() };
+        num_legal.storage().reset((map_line.DirectMap.size() + 1) * (num_ranges + 1) * 2);
 
-        const size_t result{ num_legal(map_line.DirectMap, map_line.RangeMap) };
+        fmt::print("{}\n", map_line.DirectMap);
+        const size_t result{ num_legal(num_ranges, map_line.DirectMap, map_line.RangeMap) };
         fmt::print("\t{}\n", result);
         number_configuration += result;
     }
@@ -25,18 +25,6 @@ int main(int argc, char** argv)
         [](auto str)
         { return std::vector<char>(str.begin(), str.end()); }) };
 
-    static constexpr auto transpose = [](const auto& vec)
-    {
-        const size_t num_rows{ vec.front().size() };
-        return std::views::iota(size_t{ 0 }, num_rows) |
-               std::views::transform(
-                   [&](auto i)
-                   { return vec | std::views::transform([i](const auto& inner_vec)
-                                                        { return inner_vec[i]; }) |
-                            to_vector; }) |
-               to_vector;
-    };
-
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
@@ -53,61 +41,40 @@ int main(int argc, char** argv)
     };
     static constexpr auto tilt = [](Panel& panel, Direction dir)
     {
-        // Turn our array
-        switch (dir)
-        {
-        case Direction::West:
-            panel = transpose(panel);
-            [[fallthrough]];
-        case Direction::South:
-            panel = transpose(panel);
-            [[fallthrough]];
-        case Direction::East:
-            panel = transpose(panel);
-            [[fallthrough]];
-        case Direction::North:
-            break;
-        }
+        const size_t height{ panel.size() };
+        const size_t width{ panel.front().size() };
+
+        // View the panel as lines along the tilt direction, index 0 being the edge rocks roll towards
+        const bool vertical{ dir == Direction::North || dir == Direction::South };
+        const bool reversed{ dir == Direction::South || dir == Direction::East };
+        const size_t num_lines{ vertical ? width : height };
+        const size_t line_length{ vertical ? height : width };
 
-        // Do the thing
-        for (size_t i = 0; i < panel.size(); i++)
+        // Every rock rolls to the first free cell after the last stop, no need to move rocks one by one
+        for (size_t i = 0; i < num_lines; i++)
         {
-            PanelRow& row{ panel[i] };
-            for (size_t j = 0; j < panel.size(); j++)
+            const auto at = [&](size_t j) -> char&
             {
-                if (row[j] == '.')
+                const size_t along{ reversed ? line_length - j - 1 : j };
+                return vertical ? panel[along][i] : panel[i][along];
+            };
+
+            size_t first_free{ 0 };
+            for (size_t j = 0; j < line_length; j++)
+            {
+                char& cell{ at(j) };
+                if (cell == '#')
+                {
+                    first_free = j + 1;
+                }
+                else if (cell == 'O')
                 {
-                    for (size_t k = i + 1; k < panel.size(); k++)
-                    {
-                        char& target{ panel[k][j] };
-                        if (target == 'O')
-                        {
-                            std::swap(row[j], target);
-                        }
-                        else if (target == '#')
-                        {
-                            break;
-                        }
-                    }
+                    cell = '.';
+                    at(first_free) = 'O';
+                    first_free++;
                 }
             }
         }
-
-        // Turn back our array
-        switch (dir)
-        {
-        case Direction::East:
-            panel = transpose(panel);
-            [[fallthrough]];
-        case Direction::South:
-            panel = transpose(panel);
-            [[fallthrough]];
-        case Direction::West:
-            panel = transpose(panel);
-            [[fallthrough]];
-        case Direction::North:
-            break;
-        }
     };
 
     tilt(panel, Direction::North);
@@ -116,7 +83,7 @@ int main(int argc, char** argv)
     for (size_t i = 0; i < panel.size(); i++)
     {
         PanelRow& row{ panel[i] };
-        for (size_t j = 0; j < panel.size(); j++)
+        for (size_t j = 0; j < row.size(); j++)
         {
             if (row[j] == 'O')
             {
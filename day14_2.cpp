@@ -1,11 +1,14 @@
 ﻿#include <string_view>
 
 #include <cctype>
+#include <functional>
 #include <ranges>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "cycle.h"
+#include "flat_map.h"
 #include "tokenize.h"
 
 int main(int argc, char** argv)
@@ -25,18 +28,6 @@ int main(int argc, char** argv)
         [](auto str)
         { return std::vector<char>(str.begin(), str.end()); }) };
 
-    static constexpr auto rotate = [](const auto& vec)
-    {
-        const size_t num_rows{ vec.front().size() };
-        return std::views::iota(size_t{ 0 }, num_rows) |
-               std::views::transform(
-                   [&](auto i)
-                   { return vec | std::views::transform([i](const auto& inner_vec)
-                                                        { return inner_vec[inner_vec.size() - i - 1]; }) |
-                            to_vector; }) |
-               to_vector;
-    };
-
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
@@ -53,61 +44,40 @@ int main(int argc, char** argv)
     };
     static constexpr auto tilt = [](Panel& panel, Direction dir)
     {
-        // Turn our array
-        switch (dir)
-        {
-        case Direction::West:
-            panel = rotate(panel);
-            [[fallthrough]];
-        case Direction::South:
-            panel = rotate(panel);
-            [[fallthrough]];
-        case Direction::East:
-            panel = rotate(panel);
-            [[fallthrough]];
-        case Direction::North:
-            break;
-        }
+        const size_t height{ panel.size() };
+        const size_t width{ panel.front().size() };
 
-        // Do the thing
-        for (size_t i = 0; i < panel.size(); i++)
+        // View the panel as lines along the tilt direction, index 0 being the edge rocks roll towards
+        const bool vertical{ dir == Direction::North || dir == Direction::South };
+        const bool reversed{ dir == Direction::South || dir == Direction::East };
+        const size_t num_lines{ vertical ? width : height };
+        const size_t line_length{ vertical ? height : width };
+
+        // Every rock rolls to the first free cell after the last stop, no need to move rocks one by one
+        for (size_t i = 0; i < num_lines; i++)
         {
-            PanelRow& row{ panel[i] };
-            for (size_t j = 0; j < panel.size(); j++)
+            const auto at = [&](size_t j) -> char&
+            {
+                const size_t along{ reversed ? line_length - j - 1 : j };
+                return vertical ? panel[along][i] : panel[i][along];
+            };
+
+            size_t first_free{ 0 };
+            for (size_t j = 0; j < line_length; j++)
             {
-                if (row[j] == '.')
+                char& cell{ at(j) };
+                if (cell == '#')
+                {
+                    first_free = j + 1;
+                }
+                else if (cell == 'O')
                 {
-                    for (size_t k = i + 1; k < panel.size(); k++)
-                    {
-                        char& target{ panel[k][j] };
-                        if (target == 'O')
-                        {
-                            std::swap(row[j], target);
-                        }
-                        else if (target == '#')
-                        {
-                            break;
-                        }
-                    }
+                    cell = '.';
+                    at(first_free) = 'O';
+                    first_free++;
                 }
             }
         }
-
-        // Turn back our array
-        switch (dir)
-        {
-        case Direction::East:
-            panel = rotate(panel);
-            [[fallthrough]];
-        case Direction::South:
-            panel = rotate(panel);
-            [[fallthrough]];
-        case Direction::West:
-            panel = rotate(panel);
-            [[fallthrough]];
-        case Direction::North:
-            break;
-        }
     };
     static constexpr auto cycle = [](Panel& panel)
     {
@@ -122,7 +92,7 @@ int main(int argc, char** argv)
         for (size_t i = 0; i < panel.size(); i++)
         {
             const PanelRow& row{ panel[i] };
-            for (size_t j = 0; j < panel.size(); j++)
+            for (size_t j = 0; j < row.size(); j++)
             {
                 if (row[j] == 'O')
                 {
@@ -142,26 +112,28 @@ int main(int argc, char** argv)
         fmt::print("\n");
     };
 
-    static constexpr size_t c_WantedCycle{ 1000000000 };
-
-    std::vector<Panel> seen;
-    size_t cycle_start{ 0 };
-    size_t cycle_len{ 0 };
-    for (size_t i = 0; i <= c_WantedCycle; i++)
+    static constexpr auto hash = [](const Panel& panel)
     {
-        if (const Panel * old{ algo::find(seen, panel) })
+        // All rows hashed as if they were one string
+        uint64_t hash{ FlatMapHash<std::string_view>::c_Basis };
+        for (const PanelRow& row : panel)
         {
-            cycle_start = static_cast<size_t>(old - &seen.front());
-            cycle_len = static_cast<size_t>(seen.size() - cycle_start);
-            break;
+            hash = FlatMapHash<std::string_view>{}(std::string_view{ row.data(), row.size() }, hash);
         }
-        seen.push_back(panel);
+        return hash;
+    };
+
+    static constexpr size_t c_WantedCycle{ 1000000000 };
+
+    // Panels are cheap enough to compare that states with the same hash are verified to be equal. That
+    // replays the spin cycles, so the wanted state is rebuilt afterwards instead of recorded along the way
+    const Cycle spin_cycle{ algo::find_cycle(panel, cycle, hash, std::equal_to<>{}) };
+    for (size_t i = 0; i < spin_cycle.equivalent_step(c_WantedCycle); i++)
+    {
         cycle(panel);
     }
 
-    const Panel& wanted{ seen[cycle_start + (c_WantedCycle - cycle_start) % cycle_len] };
-
-    const size_t final_load{ load(wanted) };
+    const size_t final_load{ load(panel) };
     fmt::print("The result is: {}", final_load);
 
     return final_load != 94876;
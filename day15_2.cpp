@@ -1,6 +1,8 @@
 ﻿#include <cctype>
+#include <limits>
 #include <ranges>
 #include <string_view>
+#include <unordered_map>
 
 #include <fmt/format.h>
 
@@ -71,15 +73,27 @@ int main(int argc, char** argv)
 
     const std::vector instructions{ raw_instructions | std::views::transform(to_instruction) | to_vector };
 
+    // All lenses live in one pool, each box is an intrusive list through that pool
+    static constexpr uint32_t c_NoLens{ std::numeric_limits<uint32_t>::max() };
     struct Lens
     {
         std::string_view Label;
         uint8_t FocalLength;
+        uint32_t Previous;
+        uint32_t Next;
     };
+    std::vector<Lens> lens_pool;
+    std::vector<uint32_t> free_lenses;
+    lens_pool.reserve(instructions.size());
+
+    // Labels hash to exactly one box, so a single index covers all boxes
+    std::unordered_map<std::string_view, uint32_t> lens_by_label;
+    lens_by_label.reserve(instructions.size());
 
     struct Box
     {
-        std::vector<Lens> Lenses;
+        uint32_t First{ c_NoLens };
+        uint32_t Last{ c_NoLens };
     };
     std::array<Box, 256> boxes{};
 
@@ -88,24 +102,54 @@ int main(int argc, char** argv)
         Box& box{ boxes[inst.LabelHash] };
         if (inst.Op == Operation::Remove)
         {
-            algo::erase(box.Lenses, &Lens::Label, inst.Label);
+            const auto it{ lens_by_label.find(inst.Label) };
+            if (it == lens_by_label.end())
+            {
+                continue;
+            }
+
+            const uint32_t lens_idx{ it->second };
+            const Lens& lens{ lens_pool[lens_idx] };
+            (lens.Previous == c_NoLens ? box.First : lens_pool[lens.Previous].Next) = lens.Next;
+            (lens.Next == c_NoLens ? box.Last : lens_pool[lens.Next].Previous) = lens.Previous;
+
+            lens_by_label.erase(it);
+            free_lenses.push_back(lens_idx);
         }
-        else if (Lens * lens{ algo::find(box.Lenses, &Lens::Label, inst.Label) })
+        else if (const auto it{ lens_by_label.find(inst.Label) }; it != lens_by_label.end())
         {
-            lens->FocalLength = inst.FocalLength;
+            lens_pool[it->second].FocalLength = inst.FocalLength;
         }
         else
         {
-            box.Lenses.push_back(Lens{ inst.Label, inst.FocalLength });
+            const Lens lens{ inst.Label, inst.FocalLength, box.Last, c_NoLens };
+
+            uint32_t lens_idx{ static_cast<uint32_t>(lens_pool.size()) };
+            if (free_lenses.empty())
+            {
+                lens_pool.push_back(lens);
+            }
+            else
+            {
+                lens_idx = free_lenses.back();
+                free_lenses.pop_back();
+                lens_pool[lens_idx] = lens;
+            }
+
+            (box.Last == c_NoLens ? box.First : lens_pool[box.Last].Next) = lens_idx;
+            box.Last = lens_idx;
+            lens_by_label.emplace(inst.Label, lens_idx);
         }
     }
 
     size_t total_lens_power{ 0 };
     for (const auto& [i, box] : std::views::enumerate(boxes))
     {
-        for (const auto& [j, lens] : std::views::enumerate(box.Lenses))
+        size_t j{ 0 };
+        for (uint32_t lens_idx = box.First; lens_idx != c_NoLens; lens_idx = lens_pool[lens_idx].Next)
         {
-            total_lens_power += (i + 1) * (j + 1) * lens.FocalLength;
+            total_lens_power += static_cast<size_t>(i + 1) * (j + 1) * lens_pool[lens_idx].FocalLength;
+            j++;
         }
     }
 
@@ -1,4 +1,8 @@
-﻿#include <cctype>
+﻿#include <array>
+#include <bit>
+#include <cctype>
+#include <limits>
+#include <optional>
 #include <ranges>
 #include <string_view>
 
@@ -25,6 +29,10 @@ int main(int argc, char** argv)
 
     const std::vector contraption{ file_data | lines | to_string_views | to_vector };
 
+    const int64_t width{ static_cast<int64_t>(contraption.front().size()) };
+    const int64_t height{ static_cast<int64_t>(contraption.size()) };
+    const size_t num_cells{ static_cast<size_t>(width * height) };
+
     struct Vec2
     {
         int64_t X;
@@ -35,94 +43,307 @@ int main(int argc, char** argv)
         {
             return Vec2{ X + rhs.X, Y + rhs.Y };
         }
-        Vec2 rot_left() const
+    };
+    struct Beam
+    {
+        Vec2 Position;
+        size_t Direction;
+    };
+
+    // Right, Down, Left, Up, such that horizontal directions are even
+    static constexpr std::array<Vec2, 4> c_Directions{ Vec2{ 1, 0 }, Vec2{ 0, 1 }, Vec2{ -1, 0 }, Vec2{ 0, -1 } };
+    static constexpr size_t c_NoDirection{ 4 };
+
+    static constexpr auto deflects = [](char tile, size_t dir)
+    {
+        const bool horizontal{ dir % 2 == 0 };
+        return tile == '/' || tile == '\\' || (tile == '|' && horizontal) || (tile == '-' && !horizontal);
+    };
+    static constexpr auto deflect = [](char tile, size_t dir) -> std::array<size_t, 2>
+    {
+        switch (tile)
         {
-            return Vec2{ Y, -X };
+        case '/':
+            return { 3 - dir, c_NoDirection };
+        case '\\':
+            return { dir ^ 1, c_NoDirection };
+        case '|':
+            return { 1, 3 };
+        case '-':
+            return { 0, 2 };
         }
-        Vec2 rot_right() const
+        return { dir, c_NoDirection };
+    };
+
+    const auto in_bounds = [&](Vec2 pos)
+    {
+        return pos.X >= 0 && pos.Y >= 0 && pos.X < width && pos.Y < height;
+    };
+    const auto cell_index = [&](Vec2 pos)
+    {
+        return static_cast<size_t>(pos.Y * width + pos.X);
+    };
+    const auto tile_at = [&](Vec2 pos)
+    {
+        return contraption[pos.Y][pos.X];
+    };
+
+    // Follows a beam in a straight line, including its starting tile, until it gets deflected or leaves
+    // the contraption, returns the deflecting tile if there is one
+    const auto trace = [&](Beam beam, auto&& on_tile) -> std::optional<Vec2>
+    {
+        on_tile(beam.Position);
+        beam.Position = beam.Position + c_Directions[beam.Direction];
+        while (in_bounds(beam.Position))
         {
-            return Vec2{ -Y, X };
+            on_tile(beam.Position);
+            if (deflects(tile_at(beam.Position), beam.Direction))
+            {
+                return beam.Position;
+            }
+            beam.Position = beam.Position + c_Directions[beam.Direction];
         }
+        return std::nullopt;
     };
-    struct Beam
+
+    // Every segment starts on a mirror or splitter and is identified by that tile plus its direction,
+    // a segment's successors are the segments leaving the tile it ends on
+    using CellSet = std::vector<uint64_t>;
+    const size_t num_words{ (num_cells + 63) / 64 };
+    const size_t num_segments{ num_cells * 4 };
+    const auto segment_index = [&](Vec2 pos, size_t dir)
     {
-        Vec2 Position;
-        Vec2 Direction;
+        return static_cast<uint32_t>(cell_index(pos) * 4 + dir);
+    };
+    const auto segment_beam = [&](uint32_t segment)
+    {
+        const size_t cell{ segment / 4 };
+        return Beam{ Vec2{ static_cast<int64_t>(cell) % width, static_cast<int64_t>(cell) / width }, segment % 4 };
+    };
+    const auto successors = [&](uint32_t segment)
+    {
+        const Beam beam{ segment_beam(segment) };
+        std::array<uint32_t, 2> next{};
+        size_t num_next{ 0 };
+        if (const auto end{ trace(beam, [](Vec2) {}) })
+        {
+            for (const size_t dir : deflect(tile_at(end.value()), beam.Direction))
+            {
+                if (dir != c_NoDirection)
+                {
+                    next[num_next++] = segment_index(end.value(), dir);
+                }
+            }
+        }
+        return std::pair{ next, num_next };
     };
 
-    const auto get_energized = [&](Beam starting_beam)
+    // Condense the segment graph into strongly connected components with an iterative Tarjan. Each component
+    // only stores the tiles its own segments cross and the components it leads to, both flattened into offset
+    // arrays, so memory stays linear in the grid no matter how many components there are
+    static constexpr uint32_t c_Unvisited{ std::numeric_limits<uint32_t>::max() };
+    std::vector<uint32_t> visit_order(num_segments, c_Unvisited);
+    std::vector<uint32_t> low_link(num_segments, 0);
+    std::vector<uint32_t> component_of(num_segments, c_Unvisited);
+    std::vector<uint32_t> component_stack;
+    std::vector<uint32_t> component_cell_offsets{ 0 };
+    std::vector<uint32_t> component_cells;
+    std::vector<uint32_t> component_next_offsets{ 0 };
+    std::vector<uint32_t> component_next;
+    uint32_t next_visit_order{ 0 };
+
+    struct Frame
     {
-        std::vector energized(contraption.size(), std::vector(contraption.front().size(), ' '));
-        std::vector analyzed(contraption.size(), std::vector(contraption.front().size(), std::vector<Vec2>{}));
+        uint32_t Segment;
+        std::array<uint32_t, 2> Next;
+        size_t NumNext;
+        size_t NextToVisit;
+    };
+    std::vector<Frame> call_stack;
 
-        std::vector<Beam> beams{ starting_beam };
-        while (!beams.empty())
+    const auto push_segment = [&](uint32_t segment)
+    {
+        visit_order[segment] = next_visit_order;
+        low_link[segment] = next_visit_order;
+        next_visit_order++;
+        component_stack.push_back(segment);
+        const auto [next, num_next]{ successors(segment) };
+        call_stack.push_back(Frame{ segment, next, num_next, 0 });
+    };
+    const auto condense_from = [&](uint32_t root)
+    {
+        push_segment(root);
+        while (!call_stack.empty())
         {
-            for (auto it = beams.begin(); it != beams.end();)
+            Frame& frame{ call_stack.back() };
+            if (frame.NextToVisit < frame.NumNext)
             {
+                const uint32_t next{ frame.Next[frame.NextToVisit++] };
+                if (visit_order[next] == c_Unvisited)
                 {
-                    Beam& beam{ *it };
+                    push_segment(next);
+                }
+                else if (component_of[next] == c_Unvisited)
+                {
+                    low_link[frame.Segment] = std::min(low_link[frame.Segment], visit_order[next]);
+                }
+                continue;
+            }
 
-                    const auto& [x, y] = beam.Position;
-                    const auto& [dx, dy] = beam.Direction;
+            const uint32_t segment{ frame.Segment };
+            call_stack.pop_back();
+            if (!call_stack.empty())
+            {
+                const uint32_t parent{ call_stack.back().Segment };
+                low_link[parent] = std::min(low_link[parent], low_link[segment]);
+            }
 
-                    energized[y][x] = '0';
+            if (low_link[segment] == visit_order[segment])
+            {
+                const uint32_t component{ static_cast<uint32_t>(component_cell_offsets.size() - 1) };
+                std::vector<uint32_t> members;
+                do
+                {
+                    members.push_back(component_stack.back());
+                    component_stack.pop_back();
+                    component_of[members.back()] = component;
+                } while (members.back() != segment);
+
+                for (const uint32_t member : members)
+                {
+                    trace(segment_beam(member),
+                          [&](Vec2 pos)
+                          { component_cells.push_back(static_cast<uint32_t>(cell_index(pos))); });
 
-                    const char& tile{ contraption[y][x] };
-                    switch (tile)
+                    const auto [next, num_next]{ successors(member) };
+                    for (size_t i = 0; i < num_next; i++)
                     {
-                    case '/':
-                        beam.Direction = dx != 0
-                                             ? beam.Direction.rot_left()
-                                             : beam.Direction.rot_right();
-                        break;
-                    case '\\':
-                        beam.Direction = dy != 0
-                                             ? beam.Direction.rot_left()
-                                             : beam.Direction.rot_right();
-                        break;
-                    case '|':
-                        if (dx != 0)
-                        {
-                            Beam split_beam{ beam.Position, beam.Direction.rot_right() };
-                            beam.Direction = beam.Direction.rot_left();
-                            it = beams.insert(it, split_beam);
-                        }
-                        break;
-                    case '-':
-                        if (dy != 0)
+                        const uint32_t next_component{ component_of[next[i]] };
+                        if (next_component != component)
                         {
-                            Beam split_beam{ beam.Position, beam.Direction.rot_right() };
-                            beam.Direction = beam.Direction.rot_left();
-                            it = beams.insert(it, split_beam);
+                            component_next.push_back(next_component);
                         }
-                        break;
                     }
                 }
+                component_cell_offsets.push_back(static_cast<uint32_t>(component_cells.size()));
+                component_next_offsets.push_back(static_cast<uint32_t>(component_next.size()));
+            }
+        }
+    };
 
-                Beam& beam{ *it };
-                beam.Position = beam.Position + beam.Direction;
+    // The tiles energized from a component are the union over all components reachable from it in the
+    // condensed graph. Components that entry points start from repeatedly, usually the ones feeding into a
+    // large loop, get that union cached as a full bitset, there are only few of them so memory stays bounded
+    static constexpr size_t c_MaxDenseComponents{ 64 };
+    static constexpr uint32_t c_NotDense{ std::numeric_limits<uint32_t>::max() };
+    std::vector<uint32_t> component_stamp;
+    std::vector<uint32_t> component_num_starts;
+    std::vector<uint32_t> component_dense;
+    std::vector<CellSet> dense_energized;
+    std::vector<uint32_t> pending_components;
+    uint32_t stamp{ 0 };
+
+    const auto set_cell = [](CellSet& energized, size_t cell)
+    {
+        energized[cell / 64] |= uint64_t{ 1 } << (cell % 64);
+    };
+    const auto walk_components = [&](uint32_t root, CellSet& energized)
+    {
+        stamp++;
+        pending_components.push_back(root);
+        while (!pending_components.empty())
+        {
+            const uint32_t component{ pending_components.back() };
+            pending_components.pop_back();
+            if (component_stamp[component] == stamp)
+            {
+                continue;
+            }
+            component_stamp[component] = stamp;
 
-                const auto& [x, y] = beam.Position;
-                if (x < 0 ||
-                    y < 0 ||
-                    static_cast<size_t>(x) >= contraption.size() ||
-                    static_cast<size_t>(y) >= contraption.front().size() ||
-                    algo::contains(analyzed[y][x], beam.Direction))
+            if (component != root && component_dense[component] != c_NotDense)
+            {
+                const CellSet& dense{ dense_energized[component_dense[component]] };
+                for (size_t w = 0; w < num_words; w++)
                 {
-                    it = beams.erase(it);
+                    energized[w] |= dense[w];
                 }
-                else
+                continue;
+            }
+
+            for (uint32_t i = component_cell_offsets[component]; i < component_cell_offsets[component + 1]; i++)
+            {
+                set_cell(energized, component_cells[i]);
+            }
+            for (uint32_t i = component_next_offsets[component]; i < component_next_offsets[component + 1]; i++)
+            {
+                pending_components.push_back(component_next[i]);
+            }
+        }
+    };
+
+    const auto get_energized = [&](Beam starting_beam)
+    {
+        CellSet energized(num_words, 0);
+        const auto add_component = [&](uint32_t segment)
+        {
+            if (visit_order[segment] == c_Unvisited)
+            {
+                condense_from(segment);
+                const size_t num_components{ component_cell_offsets.size() - 1 };
+                component_stamp.resize(num_components, 0);
+                component_num_starts.resize(num_components, 0);
+                component_dense.resize(num_components, c_NotDense);
+            }
+
+            const uint32_t component{ component_of[segment] };
+            component_num_starts[component]++;
+            if (component_dense[component] == c_NotDense &&
+                component_num_starts[component] > 1 &&
+                dense_energized.size() < c_MaxDenseComponents)
+            {
+                CellSet dense(num_words, 0);
+                walk_components(component, dense);
+                component_dense[component] = static_cast<uint32_t>(dense_energized.size());
+                dense_energized.push_back(std::move(dense));
+            }
+
+            if (component_dense[component] != c_NotDense)
+            {
+                const CellSet& dense{ dense_energized[component_dense[component]] };
+                for (size_t w = 0; w < num_words; w++)
                 {
-                    analyzed[y][x].push_back(beam.Direction);
-                    ++it;
+                    energized[w] |= dense[w];
+                }
+            }
+            else
+            {
+                walk_components(component, energized);
+            }
+        };
+
+        // The entry tile may deflect right away, otherwise walk to the first segment
+        std::optional<Vec2> first_deflection{ starting_beam.Position };
+        if (!deflects(tile_at(starting_beam.Position), starting_beam.Direction))
+        {
+            first_deflection = trace(starting_beam,
+                                     [&](Vec2 pos)
+                                     { set_cell(energized, cell_index(pos)); });
+        }
+        if (first_deflection)
+        {
+            for (const size_t dir : deflect(tile_at(first_deflection.value()), starting_beam.Direction))
+            {
+                if (dir != c_NoDirection)
+                {
+                    add_component(segment_index(first_deflection.value(), dir));
                 }
             }
         }
 
         const size_t num_energized{ algo::accumulate(
-            energized, [](size_t v, const auto& row)
-            { return v + algo::count(row, '0'); },
+            energized, [](size_t v, uint64_t word)
+            { return v + static_cast<size_t>(std::popcount(word)); },
             size_t{ 0 }) };
         return num_energized;
     };
@@ -130,19 +351,16 @@ int main(int argc, char** argv)
     const std::vector starting_beams{
         [&]()
         {
-            const int64_t max_x{ static_cast<int64_t>(contraption.size()) - 1 };
-            const int64_t max_y{ static_cast<int64_t>(contraption.front().size()) - 1 };
-
             std::vector<Beam> beams;
-            for (int64_t x = 0; x <= max_x; x++)
+            for (int64_t x = 0; x < width; x++)
             {
-                beams.push_back({ { x, 0 }, { 0, 1 } });
-                beams.push_back({ { x, max_y }, { 0, -1 } });
+                beams.push_back({ { x, 0 }, 1 });
+                beams.push_back({ { x, height - 1 }, 3 });
             }
-            for (int64_t y = 0; y <= max_y; y++)
+            for (int64_t y = 0; y < height; y++)
             {
-                beams.push_back({ { 0, y }, { 1, 0 } });
-                beams.push_back({ { max_x, y }, { -1, 0 } });
+                beams.push_back({ { 0, y }, 0 });
+                beams.push_back({ { width - 1, y }, 2 });
             }
             return beams;
         }()
@@ -7,6 +7,9 @@
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "int128.h"
+#include "lattice_loop.h"
+#include "perfect_hash.h"
 
 enum class Direction : uint8_t
 {
@@ -16,6 +19,9 @@ enum class Direction : uint8_t
     Right,
 };
 
+// Names of all directions as they appear in the input, in the same order as Direction
+using DirectionNames = PerfectHash<"U", "D", "L", "R">;
+
 struct Vec2
 {
     int64_t X;
@@ -66,13 +72,6 @@ struct Instruction
     int64_t Dist;
 };
 
-struct Outline
-{
-    Color Col;
-    Vec2 From;
-    Vec2 To;
-};
-
 int main(int argc, char** argv)
 {
     if (argc != 2)
@@ -95,22 +94,9 @@ int main(int argc, char** argv)
         uint32_t col{ std::stoul(std::string{ algo::trim(str, "#()"sv) }, nullptr, 16) };
         return reinterpret_cast<Color&>(col);
     };
-    static constexpr auto to_direction =
-        [](char c)
+    static constexpr auto to_direction = [](std::string_view str)
     {
-        using enum Direction;
-        switch (c)
-        {
-        case 'R':
-            return Right;
-        case 'L':
-            return Left;
-        case 'D':
-            return Down;
-        case 'U':
-        default:
-            return Up;
-        }
+        return static_cast<Direction>(DirectionNames::find(str).value());
     };
     static constexpr auto to_instructions{ std::views::transform(
         [](auto str)
@@ -119,7 +105,7 @@ int main(int argc, char** argv)
 
             return Instruction{
                 to_color(parts[2]),
-                to_direction(parts[0][0]),
+                to_direction(parts[0]),
                 algo::stoi<int64_t>(parts[1]),
             };
         }) };
@@ -127,117 +113,14 @@ int main(int argc, char** argv)
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
-    const std::vector instructions{ file_data | lines | to_string_views | to_instructions | to_vector };
-
-    std::vector<Outline> outline;
-    Vec2 min{ 0, 0 };
-    Vec2 max{ 0, 0 };
-
-    {
-        Vec2 current_pos{ 0, 0 };
-        for (const auto& inst : instructions)
-        {
-            const Vec2 next_pos{ current_pos + c_Directions[size_t(inst.Dir)] * inst.Dist };
-            outline.push_back({ inst.Col, current_pos, next_pos });
-            current_pos = next_pos;
-
-            min.X = std::min(current_pos.X, min.X);
-            min.Y = std::min(current_pos.Y, min.Y);
-            max.X = std::max(current_pos.X, max.X);
-            max.Y = std::max(current_pos.Y, max.Y);
-        }
-    }
-
-    if (min.X != 0 || min.Y != 0)
-    {
-        for (auto& out : outline)
-        {
-            out.From = out.From - min;
-            out.To = out.To - min;
-        }
-
-        max = max - min;
-        min = min - min;
-    }
-
-    std::vector pool(max.Y + 1, std::vector(max.X + 1, ' '));
-    std::vector border(max.Y + 1, std::vector(max.X + 1, ' '));
-    for (const auto& out : outline)
+    LatticeLoop lagoon{};
+    for (const Instruction& inst : file_data | lines | to_string_views | to_instructions)
     {
-        const auto min_x{ std::min(out.From.X, out.To.X) };
-        const auto max_x{ std::max(out.From.X, out.To.X) };
-        const auto min_y{ std::min(out.From.Y, out.To.Y) };
-        const auto max_y{ std::max(out.From.Y, out.To.Y) };
-        for (auto x = min_x; x <= max_x; x++)
-        {
-            for (auto y = min_y; y <= max_y; y++)
-            {
-                pool[y][x] = '0';
-
-                if (min_x != max_x)
-                {
-                    if (x != min_x && x != max_x)
-                    {
-                        border[y][x] = min_x == out.From.X
-                                           ? '>'
-                                           : '<';
-                    }
-                }
-                else
-                {
-                    if (y != min_y && y != max_y)
-                    {
-                        border[y][x] = min_y == out.From.Y
-                                           ? 'V'
-                                           : 'A';
-                    }
-                    else
-                    {
-                        border[y][x] = min_y == out.From.Y
-                                           ? 'Y'
-                                           : '^';
-                    }
-                }
-            }
-        }
-    }
-
-    for (size_t y = 0; y < pool.size(); y++)
-    {
-        auto& row{ pool[y] };
-        int64_t inside{ 0 };
-        for (size_t x = 0; x < row.size(); x++)
-        {
-            auto& c{ row[x] };
-            if (c != ' ')
-            {
-                const auto& b{ border[y][x] };
-                switch (b)
-                {
-                case 'A':
-                    inside -= 2;
-                    break;
-                case '^':
-                    inside -= 1;
-                    break;
-                case 'V':
-                    inside += 2;
-                    break;
-                case 'Y':
-                    inside += 1;
-                    break;
-                default:
-                    break;
-                }
-            }
-            else if (inside != 0)
-            {
-                c = '0';
-            }
-        }
+        const Vec2 dir{ c_Directions[size_t(inst.Dir)] };
+        lagoon.move(dir.X, dir.Y, inst.Dist);
     }
 
-    const int64_t total_volume{ algo::count(pool | std::views::join, '0') };
-    fmt::print("The result is: {}", total_volume);
+    const int128_t total_volume{ lagoon.num_points() };
+    fmt::print("The result is: {}", algo::to_string(total_volume));
     return total_volume != 40714;
 }
@@ -7,6 +7,8 @@
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "int128.h"
+#include "lattice_loop.h"
 
 struct Vec2
 {
@@ -110,35 +112,14 @@ int main(int argc, char** argv)
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
-    const std::vector instructions{ file_data | lines | to_string_views | to_instructions | to_vector };
-
-    std::vector<Vec2> vertices;
-    int64_t on_edge{ 0 };
-
+    LatticeLoop lagoon{};
+    for (const Instruction& inst : file_data | lines | to_string_views | to_instructions)
     {
-        Vec2 current_pos{ 0, 0 };
-        for (const auto& inst : instructions)
-        {
-            const Vec2 next_pos{ current_pos + c_Directions[size_t(inst.Dir)] * inst.Dist };
-            vertices.push_back(next_pos);
-            on_edge += inst.Dist;
-            current_pos = next_pos;
-        }
+        const Vec2 dir{ c_Directions[size_t(inst.Dir)] };
+        lagoon.move(dir.X, dir.Y, inst.Dist);
     }
 
-    static constexpr auto area_by_shoelace = [](const auto& vertices)
-    {
-        int64_t area{ 0 };
-        size_t j{ vertices.size() - 1 };
-        for (size_t i = 0; i < vertices.size(); i++)
-        {
-            area += (vertices[j].X + vertices[i].X) * (vertices[j].Y - vertices[i].Y);
-            j = i;
-        }
-        return std::abs(area / 2);
-    };
-
-    const int64_t total_volume{ area_by_shoelace(vertices) + on_edge / 2 + 1 };
-    fmt::print("The result is: {}", total_volume);
+    const int128_t total_volume{ lagoon.num_points() };
+    fmt::print("The result is: {}", algo::to_string(total_volume));
     return total_volume != 129849166997110;
 }
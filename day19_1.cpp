@@ -1,25 +1,20 @@
+#include <array>
 #include <cctype>
 #include <compare>
+#include <limits>
 #include <queue>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
 #include "algorithms.h"
 #include "tokenize.h"
-
-enum class PartCategory
-{
-    ExtremelyCoolLooking,
-    Musical,
-    Aerodynamic,
-    Shiny,
-    Count,
-
-    Cool = ExtremelyCoolLooking,
-    Dynamic = Aerodynamic,
-};
+#include "workflow_program.h"
 
 template<class T>
 using CategoryArray = std::array<T, static_cast<size_t>(PartCategory::Count)>;
@@ -29,25 +24,87 @@ struct Part
     CategoryArray<int64_t> Ratings;
 };
 
-struct WorkflowRule
-{
-    PartCategory Category;
-    bool LessThan; // otherwise greater than
-    int64_t Rating;
-    std::string_view NextWorkflow;
-};
+// Full blocks of 16 parts are run through the program as four SSE2 vectors of lanes where the target has
+// SSE2, each lane following its own instruction. Define AOC_DAY19_SCALAR to interpret every part on its own
+#if !defined(AOC_DAY19_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define AOC_DAY19_LANES
+#endif
+
+#ifdef AOC_DAY19_LANES
+inline constexpr size_t c_NumLanes{ 16 };
+template<class T>
+using LaneArray = std::array<T, c_NumLanes>;
 
-struct Workflow
+// An instruction as a closed range of passing ratings, 16 bytes so that a lane fetches it with a single load.
+// RatingOffset is the category premultiplied by the number of lanes
+struct alignas(16) LaneInstruction
 {
-    std::vector<WorkflowRule> Rules;
-    std::string_view FinalRule;
+    int32_t MinRating;
+    int32_t MaxRating;
+    uint32_t Jump;
+    uint32_t RatingOffset;
 };
 
-struct WorkflowResult
+// Runs one block until every lane is at accepted or rejected, ratings of the block are laid out per
+// category, then per lane. Returns where each lane ended up
+LaneArray<uint32_t> run_lanes(const std::vector<LaneInstruction>& lane_program, uint32_t entry, uint32_t lane_accepted, const int32_t* ratings)
 {
-    bool Accepted;
-    Part AcceptedPart;
-};
+    static constexpr size_t c_NumVectors{ c_NumLanes / 4 };
+    const __m128i* instructions{ reinterpret_cast<const __m128i*>(lane_program.data()) };
+    const __m128i ones{ _mm_set1_epi32(1) };
+    const __m128i terminals{ _mm_set1_epi32(static_cast<int32_t>(lane_accepted)) };
+
+    __m128i currents[c_NumVectors];
+    for (__m128i& current : currents)
+    {
+        current = _mm_set1_epi32(static_cast<int32_t>(entry));
+    }
+
+    bool any_running{ true };
+    while (any_running)
+    {
+        any_running = false;
+        for (size_t v = 0; v < c_NumVectors; v++)
+        {
+            alignas(16) std::array<uint32_t, 4> lanes;
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes.data()), currents[v]);
+
+            // Gather the instruction of each lane and transpose them into min, max and jump vectors
+            const __m128i first{ _mm_load_si128(instructions + lanes[0]) };
+            const __m128i second{ _mm_load_si128(instructions + lanes[1]) };
+            const __m128i third{ _mm_load_si128(instructions + lanes[2]) };
+            const __m128i fourth{ _mm_load_si128(instructions + lanes[3]) };
+            const __m128i low_pairs{ _mm_unpacklo_epi32(first, second) };
+            const __m128i low_pairs_rhs{ _mm_unpacklo_epi32(third, fourth) };
+            const __m128i high_pairs{ _mm_unpackhi_epi32(first, second) };
+            const __m128i high_pairs_rhs{ _mm_unpackhi_epi32(third, fourth) };
+            const __m128i min_ratings{ _mm_unpacklo_epi64(low_pairs, low_pairs_rhs) };
+            const __m128i max_ratings{ _mm_unpackhi_epi64(low_pairs, low_pairs_rhs) };
+            const __m128i jumps{ _mm_unpacklo_epi64(high_pairs, high_pairs_rhs) };
+
+            const int32_t* lane_ratings{ ratings + v * 4 };
+            const __m128i rating{ _mm_setr_epi32(lane_ratings[lane_program[lanes[0]].RatingOffset],
+                                                 lane_ratings[lane_program[lanes[1]].RatingOffset + 1],
+                                                 lane_ratings[lane_program[lanes[2]].RatingOffset + 2],
+                                                 lane_ratings[lane_program[lanes[3]].RatingOffset + 3]) };
+
+            // Lanes that pass take their jump, all others fall through to the next instruction
+            const __m128i failed{ _mm_or_si128(_mm_cmplt_epi32(rating, min_ratings), _mm_cmpgt_epi32(rating, max_ratings)) };
+            const __m128i next{ _mm_add_epi32(currents[v], ones) };
+            currents[v] = _mm_or_si128(_mm_and_si128(failed, next), _mm_andnot_si128(failed, jumps));
+
+            any_running = any_running || _mm_movemask_epi8(_mm_cmplt_epi32(currents[v], terminals)) != 0;
+        }
+    }
+
+    alignas(16) LaneArray<uint32_t> final_instructions;
+    for (size_t v = 0; v < c_NumVectors; v++)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i*>(final_instructions.data() + v * 4), currents[v]);
+    }
+    return final_instructions;
+}
+#endif
 
 int main(int argc, char** argv)
 {
@@ -58,70 +115,10 @@ int main(int argc, char** argv)
     }
 
     static constexpr auto to_vector{ std::ranges::to<std::vector>() };
-    static constexpr auto to_unordered_map{ std::ranges::to<std::unordered_map>() };
     static constexpr auto lines{ std::views::split('\n') };
     static constexpr auto to_string_views{ std::views::transform(
         [](auto str)
         { return std::string_view(str.data(), str.size()); }) };
-
-    static constexpr auto to_category = [](auto str)
-    {
-        using enum PartCategory;
-        if (str == "x")
-        {
-            return Cool;
-        }
-        else if (str == "m")
-        {
-            return Musical;
-        }
-        else if (str == "a")
-        {
-            return Dynamic;
-        }
-        else
-        {
-            return Shiny;
-        }
-    };
-
-    static constexpr auto to_workflow_rule = [](auto str)
-    {
-        const std::vector parts{ algo::split<"<>:", TokenizeBehavior::AnyOfDelimiter>(str) };
-        return WorkflowRule{
-            to_category(parts[0]),
-            str[1] == '<',
-            algo::stoi<int64_t>(parts[1]),
-            parts[2],
-        };
-    };
-    static constexpr auto to_workflows{ std::views::transform(
-        [](auto str)
-        {
-            using namespace std::string_view_literals;
-            auto name_and_rules{ str | std::views::split('{') | to_string_views | to_vector };
-            const auto name{ name_and_rules[0] };
-            std::vector rules{
-                algo::trim(name_and_rules[1], '}') |
-                std::views::split(',') |
-                to_string_views |
-                to_vector
-            };
-            auto last_rule{ rules.back() };
-            rules.pop_back();
-            auto first_rules{
-                rules |
-                std::views::transform(to_workflow_rule)
-            };
-
-            return std::pair<std::string_view, Workflow>{
-                name,
-                Workflow{
-                    first_rules | to_vector,
-                    last_rule,
-                },
-            };
-        }) };
     static constexpr auto to_parts{ std::views::transform(
         [](auto str)
         {
@@ -137,7 +134,7 @@ int main(int argc, char** argv)
                                                        std::views::split('=') |
                                                        to_string_views |
                                                        to_vector };
-                        return std::pair{ to_category(cat_and_val[0]), algo::stoi<int64_t>(cat_and_val[1]) };
+                        return std::pair{ algo::to_category(cat_and_val[0]), algo::stoi<int64_t>(cat_and_val[1]) };
                     })
             };
 
@@ -154,49 +151,112 @@ int main(int argc, char** argv)
 
     const std::vector blocks{ algo::split<"\n\n">(file_data) };
 
-    const std::unordered_map workflows{ blocks[0] | lines | to_string_views | to_workflows | to_unordered_map };
+    const Program program{ algo::compile_workflows(blocks[0]) };
     const std::vector parts{ blocks[1] | lines | to_string_views | to_parts | to_vector };
 
-    const auto funnel_through_workflows{
-        std::views::transform(
-            [&workflows](Part part)
-            {
-                std::string_view workflow_name{ "in" };
-                while (workflow_name != "R" && workflow_name != "A")
-                {
-                    const auto this_workflow_name{ workflow_name };
-                    const auto& workflow{ workflows.at(workflow_name) };
-                    for (const auto& rule : workflow.Rules)
-                    {
-                        const auto i{ static_cast<size_t>(rule.Category) };
-                        if ((rule.LessThan && part.Ratings[i] < rule.Rating) ||
-                            (!rule.LessThan && part.Ratings[i] > rule.Rating))
-                        {
-                            workflow_name = rule.NextWorkflow;
-                            break;
-                        }
-                    }
-
-                    if (this_workflow_name == workflow_name)
-                    {
-                        workflow_name = workflow.FinalRule;
-                    }
-                }
-                return WorkflowResult{
-                    workflow_name == "A",
-                    part,
-                };
-            }),
+    static constexpr auto is_accepted = [](const Program& program, const Part& part)
+    {
+        uint32_t current{ program.Entry };
+        while (current < c_Accepted)
+        {
+            const Instruction& instruction{ program.Instructions[current] };
+            const int64_t rating{ part.Ratings[static_cast<size_t>(instruction.Category)] };
+            const bool passed{
+                instruction.Op == Operation::Always ||
+                (instruction.Op == Operation::LessThan && rating < instruction.Rating) ||
+                (instruction.Op == Operation::GreaterThan && rating > instruction.Rating)
+            };
+            current = passed ? instruction.Jump : current + 1;
+        }
+        return current == c_Accepted;
     };
 
-    const std::vector accepted_parts{ parts | funnel_through_workflows | std::views::filter(&WorkflowResult::Accepted) | to_vector };
+    int64_t total_rating{ 0 };
+    size_t num_lane_parts{ 0 };
+
+#ifdef AOC_DAY19_LANES
+    // The lane program is the same program with a closed range of passing ratings per instruction, and
+    // accepted and rejected are two extra instructions that jump onto themselves so lanes can idle there
+    const uint32_t lane_accepted{ static_cast<uint32_t>(program.Instructions.size()) };
+    const uint32_t lane_rejected{ lane_accepted + 1 };
 
-    static constexpr auto add_ratings = [](int64_t v, WorkflowResult res)
+    // Lanes are 32 bit wide, so all ratings need to fit with room for the +1 and -1 of the ranges
+    static constexpr auto fits_lane = [](int64_t rating)
     {
-        return v + algo::accumulate(res.AcceptedPart.Ratings, int64_t{ 0 });
+        return rating > std::numeric_limits<int32_t>::min() && rating < std::numeric_limits<int32_t>::max();
     };
+    const bool program_fits_lanes{ algo::all_of(program.Instructions, [](const Instruction& instruction)
+                                                                  { return fits_lane(instruction.Rating); }) };
+    const bool parts_fit_lanes{ algo::all_of(parts, [](const Part& part)
+                                             { return algo::all_of(part.Ratings, fits_lane); }) };
+
+    if (program_fits_lanes && parts_fit_lanes)
+    {
+        std::vector<LaneInstruction> lane_program;
+        for (const Instruction& instruction : program.Instructions)
+        {
+            const int32_t rating{ static_cast<int32_t>(instruction.Rating) };
+            lane_program.push_back(LaneInstruction{
+                instruction.Op == Operation::GreaterThan ? rating + 1 : std::numeric_limits<int32_t>::min(),
+                instruction.Op == Operation::LessThan ? rating - 1 : std::numeric_limits<int32_t>::max(),
+                instruction.Jump == c_Accepted   ? lane_accepted
+                : instruction.Jump == c_Rejected ? lane_rejected
+                                                 : instruction.Jump,
+                static_cast<uint32_t>(static_cast<size_t>(instruction.Category) * c_NumLanes),
+            });
+        }
+        for (const uint32_t terminal : { lane_accepted, lane_rejected })
+        {
+            lane_program.push_back(LaneInstruction{
+                std::numeric_limits<int32_t>::min(),
+                std::numeric_limits<int32_t>::max(),
+                terminal,
+                0,
+            });
+        }
+
+        // Ratings are laid out per block, then per category, then per lane
+        const size_t num_blocks{ parts.size() / c_NumLanes };
+        std::vector<int32_t> block_ratings(num_blocks * c_NumLanes * 4);
+        for (size_t i = 0; i < num_blocks * c_NumLanes; i++)
+        {
+            const size_t block{ i / c_NumLanes };
+            const size_t lane{ i % c_NumLanes };
+            for (size_t j = 0; j < 4; j++)
+            {
+                block_ratings[(block * 4 + j) * c_NumLanes + lane] = static_cast<int32_t>(parts[i].Ratings[j]);
+            }
+        }
+
+        LaneArray<int64_t> lane_total_ratings{};
+        for (size_t block = 0; block < num_blocks; block++)
+        {
+            const int32_t* ratings{ block_ratings.data() + block * 4 * c_NumLanes };
+            const LaneArray<uint32_t> final_instructions{ run_lanes(lane_program, program.Entry, lane_accepted, ratings) };
+            for (size_t i = 0; i < c_NumLanes; i++)
+            {
+                const int64_t lane_rating{ int64_t{ ratings[i] } +
+                                           ratings[c_NumLanes + i] +
+                                           ratings[2 * c_NumLanes + i] +
+                                           ratings[3 * c_NumLanes + i] };
+                lane_total_ratings[i] += final_instructions[i] == lane_accepted ? lane_rating : 0;
+            }
+        }
+
+        total_rating += algo::accumulate(lane_total_ratings, int64_t{ 0 });
+        num_lane_parts = num_blocks * c_NumLanes;
+    }
+#endif
+
+    // Whatever did not go through the lanes is interpreted one part at a time
+    for (const Part& part : parts | std::views::drop(num_lane_parts))
+    {
+        if (is_accepted(program, part))
+        {
+            total_rating += algo::accumulate(part.Ratings, int64_t{ 0 });
+        }
+    }
 
-    const int64_t total_rating{ algo::accumulate(accepted_parts, add_ratings, int64_t{ 0 }) };
     fmt::print("The result is: {}", total_rating);
     return total_rating != 374873;
 }
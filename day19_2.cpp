@@ -1,59 +1,17 @@
 ﻿#include <cctype>
-#include <compare>
-#include <queue>
-#include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "interval_set.h"
 #include "tokenize.h"
+#include "workflow_program.h"
 
-enum class PartCategory
-{
-    ExtremelyCoolLooking,
-    Musical,
-    Aerodynamic,
-    Shiny,
-    Count,
-
-    Cool = ExtremelyCoolLooking,
-    Dynamic = Aerodynamic,
-};
-
-template<class T>
-using CategoryArray = std::array<T, static_cast<size_t>(PartCategory::Count)>;
-
-struct PartRange
-{
-    int64_t From{ 1 };
-    int64_t To{ 4000 };
-};
-
-struct RangedPart
-{
-    CategoryArray<PartRange> Ratings;
-};
-
-struct WorkflowRule
-{
-    PartCategory Category;
-    bool LessThan; // otherwise greater than
-    int64_t Rating;
-    std::string_view NextWorkflow;
-};
+// Ratings of all categories go from 1 to 4000
+inline constexpr Interval<int64_t> c_AllRatings{ 1, 4001 };
 
-struct Workflow
-{
-    std::vector<WorkflowRule> Rules;
-    std::string_view FinalRule;
-};
-
-struct WorkflowProcess
-{
-    RangedPart Part;
-    std::string_view Workflow;
-};
+using RangedPart = IntervalBox<int64_t, static_cast<size_t>(PartCategory::Count)>;
 
 int main(int argc, char** argv)
 {
@@ -63,136 +21,63 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    static constexpr auto to_vector{ std::ranges::to<std::vector>() };
-    static constexpr auto to_unordered_map{ std::ranges::to<std::unordered_map>() };
-    static constexpr auto lines{ std::views::split('\n') };
-    static constexpr auto to_string_views{ std::views::transform(
-        [](auto str)
-        { return std::string_view(str.data(), str.size()); }) };
-
-    static constexpr auto to_category = [](auto str)
-    {
-        using enum PartCategory;
-        if (str == "x")
-        {
-            return Cool;
-        }
-        else if (str == "m")
-        {
-            return Musical;
-        }
-        else if (str == "a")
-        {
-            return Dynamic;
-        }
-        else
-        {
-            return Shiny;
-        }
-    };
-
-    static constexpr auto to_workflow_rule = [](auto str)
-    {
-        const std::vector parts{ algo::split<"<>:", TokenizeBehavior::AnyOfDelimiter>(str) };
-        return WorkflowRule{
-            to_category(parts[0]),
-            str[1] == '<',
-            algo::stoi<int64_t>(parts[1]),
-            parts[2],
-        };
-    };
-    static constexpr auto to_workflows{ std::views::transform(
-        [](auto str)
-        {
-            using namespace std::string_view_literals;
-            auto name_and_rules{ str | std::views::split('{') | to_string_views | to_vector };
-            const auto name{ name_and_rules[0] };
-            std::vector rules{
-                algo::trim(name_and_rules[1], '}') |
-                std::views::split(',') |
-                to_string_views |
-                to_vector
-            };
-            auto last_rule{ rules.back() };
-            rules.pop_back();
-            auto first_rules{
-                rules |
-                std::views::transform(to_workflow_rule)
-            };
-
-            return std::pair<std::string_view, Workflow>{
-                name,
-                Workflow{
-                    first_rules | to_vector,
-                    last_rule,
-                },
-            };
-        }) };
-
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
-    const std::unordered_map workflows{ algo::split<"\n\n">(file_data)[0] | lines | to_string_views | to_workflows | to_unordered_map };
+    const Program program{ algo::compile_workflows(algo::split<"\n\n">(file_data)[0]) };
 
-    static constexpr auto count_range_combinations = [](RangedPart part)
+    struct PendingRange
     {
-        return (part.Ratings[0].To - part.Ratings[0].From + 1) *
-               (part.Ratings[1].To - part.Ratings[1].From + 1) *
-               (part.Ratings[2].To - part.Ratings[2].From + 1) *
-               (part.Ratings[3].To - part.Ratings[3].From + 1);
+        RangedPart Part;
+        uint32_t Current;
     };
-    const auto count_combinations = [&workflows](this const auto& self, WorkflowProcess process) -> int64_t
+    std::vector<PendingRange> pending_ranges{ PendingRange{ RangedPart{ { c_AllRatings, c_AllRatings, c_AllRatings, c_AllRatings } }, program.Entry } };
+
+    int64_t num_accepted_combinations{ 0 };
+    while (!pending_ranges.empty())
     {
-        if (process.Workflow == "A")
-        {
-            return count_range_combinations(process.Part);
-        }
-        else if (process.Workflow == "R")
-        {
-            return 0;
-        }
-        else
+        auto [part, current]{ pending_ranges.back() };
+        pending_ranges.pop_back();
+
+        // Walk the program, splitting off the passing part of the range whenever a rule cuts through it
+        while (current < c_Accepted)
         {
-            size_t sum_of_all{ 0 };
+            const Instruction& instruction{ program.Instructions[current] };
+            if (instruction.Op == Operation::Always)
+            {
+                current = instruction.Jump;
+                continue;
+            }
+
+            const size_t category{ static_cast<size_t>(instruction.Category) };
+            const bool less_than{ instruction.Op == Operation::LessThan };
+            const auto [below, above]{ part.split(category, less_than ? instruction.Rating : instruction.Rating + 1) };
+            const RangedPart& passed{ less_than ? below : above };
+            const RangedPart& failed{ less_than ? above : below };
 
-            const auto& part{ process.Part };
-            const auto& workflow{ workflows.at(process.Workflow) };
-            for (const auto& rule : workflow.Rules)
+            if (passed.empty())
             {
-                const auto i{ static_cast<size_t>(rule.Category) };
-                if ((rule.LessThan && part.Ratings[i].To < rule.Rating) ||
-                    (!rule.LessThan && part.Ratings[i].From > rule.Rating))
-                {
-                    return self(WorkflowProcess{ part, rule.NextWorkflow });
-                }
-                else
-                {
-                    // Failed a rule, split into two ranges ...
-                    WorkflowProcess success{ process };
-                    success.Workflow = rule.NextWorkflow;
-                    WorkflowProcess failure{ process };
-
-                    if (rule.LessThan)
-                    {
-                        success.Part.Ratings[i].To = std::min(success.Part.Ratings[i].To, rule.Rating - 1);
-                        failure.Part.Ratings[i].From = std::max(success.Part.Ratings[i].From, rule.Rating);
-                    }
-                    else
-                    {
-                        failure.Part.Ratings[i].To = std::min(success.Part.Ratings[i].To, rule.Rating);
-                        success.Part.Ratings[i].From = std::max(success.Part.Ratings[i].From, rule.Rating + 1);
-                    }
-
-                    sum_of_all += self(success);
-                    process = failure;
-                }
+                current++;
+                continue;
             }
+            else if (failed.empty())
+            {
+                current = instruction.Jump;
+                continue;
+            }
+
+            pending_ranges.push_back(PendingRange{ passed, instruction.Jump });
 
-            return sum_of_all + self(WorkflowProcess{ part, workflow.FinalRule });
+            part = failed;
+            current++;
         }
-    };
 
-    const int64_t num_accepted_combinations{ count_combinations(WorkflowProcess{ RangedPart{}, "in" }) };
+        if (current == c_Accepted)
+        {
+            num_accepted_combinations += part.volume();
+        }
+    }
+
     fmt::print("The result is: {}", num_accepted_combinations);
     return num_accepted_combinations != 122112157518711;
 }
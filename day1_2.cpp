@@ -1,11 +1,13 @@
 #include <string_view>
 
 #include <cctype>
+#include <optional>
 #include <ranges>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "perfect_hash.h"
 #include "tokenize.h"
 
 int main(int argc, char** argv)
@@ -20,98 +22,52 @@ int main(int argc, char** argv)
     const std::string file_data{ algo::read_whole_file(input_file) };
     const std::vector lines{ algo::split<'\n'>(file_data) };
 
-    using namespace std::string_view_literals;
-    static constexpr std::array valid_digits{
-        "0"sv,
-        "1"sv,
-        "one"sv,
-        "2"sv,
-        "two"sv,
-        "3"sv,
-        "three"sv,
-        "4"sv,
-        "four"sv,
-        "5"sv,
-        "five"sv,
-        "6"sv,
-        "six"sv,
-        "7"sv,
-        "seven"sv,
-        "8"sv,
-        "eight"sv,
-        "9"sv,
-        "nine"sv,
+    // Every digit is followed by its spelled out name, so the key at index i stands for (i + 1) / 2
+    using ValidDigits = PerfectHash<"0", "1", "one", "2", "two", "3", "three", "4", "four", "5", "five", "6", "six", "7", "seven", "8", "eight", "9", "nine">;
+    static constexpr auto index_to_digit = [](size_t index)
+    {
+        return (index + 1) / 2;
     };
 
-    struct DigitStrs
+    struct Digits
     {
-        std::string_view First;
-        std::string_view Last;
+        size_t First;
+        size_t Last;
     };
     auto line_to_digits = [](std::string_view lines)
     {
-        static constexpr auto find_first_digit_str = [](std::string_view str)
+        static constexpr auto find_first_digit = [](std::string_view str)
         {
             for (size_t i = 0; i < str.size(); i++)
             {
-                if (auto* digit_str{ algo::find_if(valid_digits, [str = str.substr(i)](std::string_view digit)
-                                                   { return str.starts_with(digit); }) })
+                if (const std::optional<size_t> index{ ValidDigits::find_prefix(str.substr(i)) })
                 {
-                    return *digit_str;
+                    return index_to_digit(index.value());
                 }
             }
             throw std::logic_error{
                 "Invalid input..."
             };
         };
-        const std::string_view first{ find_first_digit_str(lines) };
 
-        static constexpr auto find_last_digit_str = [](std::string_view str)
+        static constexpr auto find_last_digit = [](std::string_view str)
         {
             for (size_t i = 0; i < str.size(); i++)
             {
-                if (auto* digit_str{ algo::find_if(valid_digits, [str = str.substr(0, str.size() - i)](std::string_view digit)
-                                                   { return str.ends_with(digit); }) })
+                if (const std::optional<size_t> index{ ValidDigits::find_suffix(str.substr(0, str.size() - i)) })
                 {
-                    return *digit_str;
+                    return index_to_digit(index.value());
                 }
             }
             throw std::logic_error{
                 "Invalid input..."
             };
         };
-        const std::string_view last{ find_last_digit_str(lines) };
-        return DigitStrs{ first, last };
-    };
-    const std::vector digit_strs{
-        algo::transformed<std::vector<DigitStrs>>(
-            lines, line_to_digits),
-    };
-
-    struct Digits
-    {
-        size_t First;
-        size_t Last;
-    };
-    constexpr auto digit_strs_to_digits = [](DigitStrs digits)
-    {
-        static constexpr auto digit_str_to_number = [](std::string_view digit_str)
-        {
-            if (digit_str == "0"sv)
-            {
-                return size_t{ 0 };
-            }
-            auto* it{ algo::find(valid_digits, digit_str) };
-            return static_cast<size_t>((it - &valid_digits.front()) + 1) / 2;
-        };
-        return Digits{
-            digit_str_to_number(digits.First),
-            digit_str_to_number(digits.Last),
-        };
+        return Digits{ find_first_digit(lines), find_last_digit(lines) };
     };
     const std::vector digits{
         algo::transformed<std::vector<Digits>>(
-            digit_strs, digit_strs_to_digits),
+            lines, line_to_digits),
     };
 
     constexpr auto digits_to_number = [](Digits digits)
@@ -1,5 +1,6 @@
 #include <cctype>
 #include <compare>
+#include <optional>
 #include <queue>
 #include <ranges>
 #include <string_view>
@@ -9,13 +10,13 @@
 #include "algorithms.h"
 #include "tokenize.h"
 
-enum class Signal
+enum class Signal : uint8_t
 {
     Low,
     High,
 };
 
-enum class ModuleType
+enum class ModuleType : uint8_t
 {
     Input,
     Output,
@@ -23,49 +24,85 @@ enum class ModuleType
     Conjunction,
 };
 
-enum class ModuleState : uint8_t
-{
-    On,
-    Off,
-};
-
 struct Module;
-struct PendingSignal;
-struct FullModuleState;
 
 using ModuleList = std::vector<std::string_view>;
-using SignalList = std::vector<Signal>;
-using ModuleStateList = std::vector<FullModuleState>;
 using ModuleMap = std::unordered_map<std::string_view, Module>;
-using PendingSignalList = std::vector<PendingSignal>;
 
 struct Module
 {
     std::string_view Name;
     ModuleType Type;
     ModuleList Outputs;
+};
 
-    // For Conjunction
-    ModuleList Inputs;
-    SignalList LastSignals;
+// The network compiled down to integer ids, outputs are stored as one flat list with offsets per module and
+// each edge knows which input slot of its target it feeds
+struct Network
+{
+    std::unordered_map<std::string_view, uint32_t> Ids;
+    std::vector<ModuleType> Types;
+    std::vector<uint32_t> OutputOffsets;
+    std::vector<uint32_t> Outputs;
+    std::vector<uint32_t> OutputSlots;
+    std::vector<uint32_t> NumInputs;
+    std::vector<uint64_t> AllInputsMasks;
+};
+
+// Flip-flops are a bitset over all modules, conjunctions remember which of their inputs were high last
+struct NetworkState
+{
+    std::vector<uint64_t> FlipFlops;
+    std::vector<uint64_t> HighInputs;
 
-    // For FlipFlop
-    ModuleState State{ ModuleState::Off };
+    bool operator==(const NetworkState&) const = default;
 };
 
-struct PendingSignal
+struct Pulse
 {
-    std::string_view FromName;
-    std::string_view ToName;
+    uint32_t To;
+    uint32_t Slot;
     Signal Sig;
 };
 
-struct FullModuleState
+// Pulses are handled in the order they are sent, kept in a ring buffer that only grows if it runs full
+class PulseQueue
 {
-    ModuleState State;
-    SignalList LastSignals;
+  public:
+    bool empty() const
+    {
+        return m_Begin == m_End;
+    }
+
+    void push(const Pulse& pulse)
+    {
+        if (m_End - m_Begin == m_Pulses.size())
+        {
+            grow();
+        }
+        m_Pulses[m_End++ & (m_Pulses.size() - 1)] = pulse;
+    }
+    Pulse pop()
+    {
+        return m_Pulses[m_Begin++ & (m_Pulses.size() - 1)];
+    }
+
+  private:
+    void grow()
+    {
+        std::vector<Pulse> pulses(std::max(m_Pulses.size() * 2, size_t{ 64 }));
+        for (size_t i = m_Begin; i < m_End; i++)
+        {
+            pulses[i - m_Begin] = m_Pulses[i & (m_Pulses.size() - 1)];
+        }
+        m_End -= m_Begin;
+        m_Begin = 0;
+        m_Pulses = std::move(pulses);
+    }
 
-    bool operator==(const FullModuleState&) const = default;
+    std::vector<Pulse> m_Pulses;
+    size_t m_Begin{ 0 };
+    size_t m_End{ 0 };
 };
 
 int main(int argc, char** argv)
@@ -110,142 +147,145 @@ int main(int argc, char** argv)
                 };
             }),
     };
-    static constexpr auto to_module_state =
-        [](const auto& mod)
+    // Conjunctions keep their inputs in a single word, networks where one has more inputs are rejected
+    static constexpr auto compile_network = [](const ModuleMap& modules) -> std::optional<Network>
     {
-        using enum ModuleType;
-        switch (mod.Type)
+        Network network{};
+        const auto intern = [&](std::string_view name)
         {
-        case Input:
-            [[fallthrough]];
-        case Output:
-            return ModuleState::On;
-        case FlipFlop:
-            return mod.State;
-        case Conjunction:
-            [[fallthrough]];
-        default:
-            return algo::all_of(mod.LastSignals, [](auto sig)
-                                { return sig == Signal::High; })
-                       ? ModuleState::On
-                       : ModuleState::Off;
-        };
-    };
-    static constexpr auto to_full_module_state = [](const auto& name_mod)
-    {
-        return FullModuleState{
-            to_module_state(name_mod.second),
-            name_mod.second.LastSignals,
+            const auto [it, inserted]{ network.Ids.try_emplace(name, static_cast<uint32_t>(network.Types.size())) };
+            if (inserted)
+            {
+                // Sometimes we send signals into the void, those modules become outputs
+                const auto mod_it{ modules.find(name) };
+                network.Types.push_back(mod_it != modules.end() ? mod_it->second.Type : ModuleType::Output);
+                network.NumInputs.push_back(0);
+            }
+            return it->second;
         };
-    };
 
-    const std::string_view input_file{ argv[1] };
-    const std::string file_data{ algo::read_whole_file(input_file) };
+        std::vector<std::string_view> names;
+        for (const auto& [name, mod] : modules)
+        {
+            intern(mod.Name);
+            names.push_back(mod.Name);
+        }
 
-    std::unordered_map modules{ file_data | lines | to_string_views | to_modules | to_unordered_map };
-    for (auto& [name, mod] : modules)
-    {
-        for (auto out : mod.Outputs)
+        network.OutputOffsets.push_back(0);
+        for (const auto& name : names)
         {
-            auto it{ modules.find(out) };
-            if (it != modules.end())
+            for (const auto out : modules.at(name).Outputs)
             {
-                auto& out_mod{ it->second };
-                if (out_mod.Type == ModuleType::Conjunction)
-                {
-                    out_mod.Inputs.push_back(name);
-                    out_mod.LastSignals.push_back(Signal::Low);
-                }
+                const uint32_t to{ intern(out) };
+                network.Outputs.push_back(to);
+                network.OutputSlots.push_back(network.NumInputs[to]++);
             }
+            network.OutputOffsets.push_back(static_cast<uint32_t>(network.Outputs.size()));
         }
-    }
+        network.OutputOffsets.resize(network.Types.size() + 1, static_cast<uint32_t>(network.Outputs.size()));
 
-    static constexpr size_t c_NumberPresses{ 1000 };
-
-    std::vector<int64_t> low_signals_per_press;
-    std::vector<int64_t> high_signals_per_press;
+        for (size_t i = 0; i < network.Types.size(); i++)
+        {
+            const uint32_t num_inputs{ network.NumInputs[i] };
+            if (network.Types[i] == ModuleType::Conjunction && num_inputs > 64)
+            {
+                return std::nullopt;
+            }
+            network.AllInputsMasks.push_back(num_inputs >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << num_inputs) - 1);
+        }
 
-    for (size_t i = 0; i < c_NumberPresses; i++)
+        return network;
+    };
+    static constexpr auto initial_state = [](const Network& network)
     {
-        int64_t low_signals{ 0 };
-        int64_t high_signals{ 0 };
-        const auto count_signals = [&](Signal sig, auto num)
-        {
-            (sig == Signal::Low ? low_signals : high_signals) += static_cast<int64_t>(num);
+        return NetworkState{
+            std::vector<uint64_t>((network.Types.size() + 63) / 64, 0),
+            std::vector<uint64_t>(network.Types.size(), 0),
         };
+    };
 
-        PendingSignalList pending_signals{ { "button", "broadcaster", Signal::Low } };
-        count_signals(Signal::Low, 1);
-
-        while (!pending_signals.empty())
+    // Sends a pulse and handles everything it sets off, on_pulse gets to see each pulse before it is handled
+    // and may drop it by returning false
+    PulseQueue pulse_queue{};
+    const auto send_pulse = [&pulse_queue](const Network& network, NetworkState& state, Pulse first_pulse, auto&& on_pulse)
+    {
+        pulse_queue.push(first_pulse);
+        while (!pulse_queue.empty())
         {
-            PendingSignalList next_signals{};
-            for (auto [from, to, signal] : pending_signals)
+            const Pulse pulse{ pulse_queue.pop() };
+            if (!on_pulse(pulse))
             {
-                using enum ModuleType;
-                using enum Signal;
-                using enum ModuleState;
+                continue;
+            }
 
-                // Sometimes we send signals into the void
-                auto it{ modules.find(to) };
-                if (it != modules.end())
+            using enum ModuleType;
+            using enum Signal;
+
+            const uint32_t to{ pulse.To };
+            Signal out_sig{ pulse.Sig };
+            switch (network.Types[to])
+            {
+            case Input:
+                break;
+            case FlipFlop:
+            {
+                if (pulse.Sig == High)
                 {
-                    auto& to_mod{ it->second };
-                    switch (to_mod.Type)
-                    {
-                    case Input:
-                        for (auto& out : to_mod.Outputs)
-                        {
-                            next_signals.push_back({ to, out, signal });
-                        }
-                        count_signals(signal, to_mod.Outputs.size());
-                        break;
-                    case FlipFlop:
-                        if (signal == Low)
-                        {
-                            to_mod.State = to_mod.State == On ? Off : On;
-                            const auto out_sig{ to_mod.State == On ? High : Low };
-                            for (auto& out : to_mod.Outputs)
-                            {
-                                next_signals.push_back({ to, out, out_sig });
-                            }
-                            count_signals(out_sig, to_mod.Outputs.size());
-                        }
-                        break;
-                    case Conjunction:
-                    {
-                        for (auto [out, last_sig] : std::views::zip(to_mod.Inputs, to_mod.LastSignals))
-                        {
-                            if (out == from)
-                            {
-                                last_sig = signal;
-                            }
-                        }
-                        const auto state{ to_module_state(to_mod) };
-                        const auto out_sig{ state == On ? Low : High };
-                        for (auto& out : to_mod.Outputs)
-                        {
-                            next_signals.push_back({ to, out, out_sig });
-                        }
-                        count_signals(out_sig, to_mod.Outputs.size());
-                        break;
-                    }
-                    case Output:
-                    default:
-                        break;
-                    }
+                    continue;
                 }
+                uint64_t& flip_flops{ state.FlipFlops[to / 64] };
+                const uint64_t flip_flop{ uint64_t{ 1 } << (to % 64) };
+                flip_flops ^= flip_flop;
+                out_sig = (flip_flops & flip_flop) != 0 ? High : Low;
+                break;
+            }
+            case Conjunction:
+            {
+                uint64_t& high_inputs{ state.HighInputs[to] };
+                const uint64_t input{ uint64_t{ 1 } << pulse.Slot };
+                high_inputs = pulse.Sig == High ? high_inputs | input : high_inputs & ~input;
+                out_sig = high_inputs == network.AllInputsMasks[to] ? Low : High;
+                break;
+            }
+            case Output:
+            default:
+                continue;
             }
 
-            std::swap(pending_signals, next_signals);
+            for (uint32_t i = network.OutputOffsets[to]; i < network.OutputOffsets[to + 1]; i++)
+            {
+                pulse_queue.push(Pulse{ network.Outputs[i], network.OutputSlots[i], out_sig });
+            }
         }
+    };
 
-        low_signals_per_press.push_back(low_signals);
-        high_signals_per_press.push_back(high_signals);
+    const std::string_view input_file{ argv[1] };
+    const std::string file_data{ algo::read_whole_file(input_file) };
+
+    const ModuleMap modules{ file_data | lines | to_string_views | to_modules | to_unordered_map };
+    const std::optional<Network> compiled_network{ compile_network(modules) };
+    if (!compiled_network)
+    {
+        fmt::print("Conjunctions with more than 64 inputs are not supported");
+        return 1;
     }
+    const Network& network{ compiled_network.value() };
+    NetworkState state{ initial_state(network) };
+
+    static constexpr size_t c_NumberPresses{ 1000 };
 
-    const size_t total_low_signals{ algo::accumulate(low_signals_per_press, size_t{ 0 }) };
-    const size_t total_high_signals{ algo::accumulate(high_signals_per_press, size_t{ 0 }) };
+    size_t total_low_signals{ 0 };
+    size_t total_high_signals{ 0 };
+    const auto count_signals = [&](const Pulse& pulse)
+    {
+        (pulse.Sig == Signal::Low ? total_low_signals : total_high_signals)++;
+        return true;
+    };
+
+    for (size_t i = 0; i < c_NumberPresses; i++)
+    {
+        send_pulse(network, state, Pulse{ network.Ids.at("broadcaster"), 0, Signal::Low }, count_signals);
+    }
 
     const size_t num_signals_sent{ total_low_signals * total_high_signals };
     fmt::print("The result is: {}", num_signals_sent);
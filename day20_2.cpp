@@ -1,21 +1,29 @@
 ﻿#include <cctype>
 #include <compare>
+#include <functional>
+#include <limits>
+#include <optional>
 #include <queue>
 #include <ranges>
+#include <span>
 #include <string_view>
+#include <utility>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "cycle.h"
+#include "flat_map.h"
+#include "int128.h"
 #include "tokenize.h"
 
-enum class Signal
+enum class Signal : uint8_t
 {
     Low,
     High,
 };
 
-enum class ModuleType
+enum class ModuleType : uint8_t
 {
     Input,
     Output,
@@ -23,49 +31,86 @@ enum class ModuleType
     Conjunction,
 };
 
-enum class ModuleState : uint8_t
-{
-    On,
-    Off,
-};
-
 struct Module;
-struct PendingSignal;
-struct FullModuleState;
 
 using ModuleList = std::vector<std::string_view>;
-using SignalList = std::vector<Signal>;
-using ModuleStateList = std::vector<FullModuleState>;
 using ModuleMap = std::unordered_map<std::string_view, Module>;
-using PendingSignalList = std::vector<PendingSignal>;
 
 struct Module
 {
     std::string_view Name;
     ModuleType Type;
     ModuleList Outputs;
+};
 
-    // For Conjunction
-    ModuleList Inputs;
-    SignalList LastSignals;
+// The network compiled down to integer ids, outputs are stored as one flat list with offsets per module and
+// each edge knows which input slot of its target it feeds
+struct Network
+{
+    std::unordered_map<std::string_view, uint32_t> Ids;
+    std::vector<std::string_view> Names;
+    std::vector<ModuleType> Types;
+    std::vector<uint32_t> OutputOffsets;
+    std::vector<uint32_t> Outputs;
+    std::vector<uint32_t> OutputSlots;
+    std::vector<uint32_t> NumInputs;
+    std::vector<uint64_t> AllInputsMasks;
+};
+
+// Flip-flops are a bitset over all modules, conjunctions remember which of their inputs were high last
+struct NetworkState
+{
+    std::vector<uint64_t> FlipFlops;
+    std::vector<uint64_t> HighInputs;
 
-    // For FlipFlop
-    ModuleState State{ ModuleState::Off };
+    bool operator==(const NetworkState&) const = default;
 };
 
-struct PendingSignal
+struct Pulse
 {
-    std::string_view FromName;
-    std::string_view ToName;
+    uint32_t To;
+    uint32_t Slot;
     Signal Sig;
 };
 
-struct FullModuleState
+// Pulses are handled in the order they are sent, kept in a ring buffer that only grows if it runs full
+class PulseQueue
 {
-    ModuleState State;
-    SignalList LastSignals;
+  public:
+    bool empty() const
+    {
+        return m_Begin == m_End;
+    }
+
+    void push(const Pulse& pulse)
+    {
+        if (m_End - m_Begin == m_Pulses.size())
+        {
+            grow();
+        }
+        m_Pulses[m_End++ & (m_Pulses.size() - 1)] = pulse;
+    }
+    Pulse pop()
+    {
+        return m_Pulses[m_Begin++ & (m_Pulses.size() - 1)];
+    }
 
-    bool operator==(const FullModuleState&) const = default;
+  private:
+    void grow()
+    {
+        std::vector<Pulse> pulses(std::max(m_Pulses.size() * 2, size_t{ 64 }));
+        for (size_t i = m_Begin; i < m_End; i++)
+        {
+            pulses[i - m_Begin] = m_Pulses[i & (m_Pulses.size() - 1)];
+        }
+        m_End -= m_Begin;
+        m_Begin = 0;
+        m_Pulses = std::move(pulses);
+    }
+
+    std::vector<Pulse> m_Pulses;
+    size_t m_Begin{ 0 };
+    size_t m_End{ 0 };
 };
 
 int main(int argc, char** argv)
@@ -110,200 +155,339 @@ int main(int argc, char** argv)
                 };
             }),
     };
-    static constexpr auto to_module_state =
-        [](const auto& mod)
+    // Conjunctions keep their inputs in a single word, networks where one has more inputs are rejected
+    static constexpr auto compile_network = [](const ModuleMap& modules) -> std::optional<Network>
     {
-        using enum ModuleType;
-        switch (mod.Type)
+        Network network{};
+        const auto intern = [&](std::string_view name)
         {
-        case Input:
-            [[fallthrough]];
-        case Output:
-            return ModuleState::On;
-        case FlipFlop:
-            return mod.State;
-        case Conjunction:
-            [[fallthrough]];
-        default:
-            return algo::all_of(mod.LastSignals, [](auto sig)
-                                { return sig == Signal::High; })
-                       ? ModuleState::On
-                       : ModuleState::Off;
+            const auto [it, inserted]{ network.Ids.try_emplace(name, static_cast<uint32_t>(network.Types.size())) };
+            if (inserted)
+            {
+                // Sometimes we send signals into the void, those modules become outputs
+                const auto mod_it{ modules.find(name) };
+                network.Names.push_back(name);
+                network.Types.push_back(mod_it != modules.end() ? mod_it->second.Type : ModuleType::Output);
+                network.NumInputs.push_back(0);
+            }
+            return it->second;
         };
+
+        std::vector<std::string_view> names;
+        for (const auto& [name, mod] : modules)
+        {
+            intern(mod.Name);
+            names.push_back(mod.Name);
+        }
+
+        network.OutputOffsets.push_back(0);
+        for (const auto& name : names)
+        {
+            for (const auto out : modules.at(name).Outputs)
+            {
+                const uint32_t to{ intern(out) };
+                network.Outputs.push_back(to);
+                network.OutputSlots.push_back(network.NumInputs[to]++);
+            }
+            network.OutputOffsets.push_back(static_cast<uint32_t>(network.Outputs.size()));
+        }
+        network.OutputOffsets.resize(network.Types.size() + 1, static_cast<uint32_t>(network.Outputs.size()));
+
+        for (size_t i = 0; i < network.Types.size(); i++)
+        {
+            const uint32_t num_inputs{ network.NumInputs[i] };
+            if (network.Types[i] == ModuleType::Conjunction && num_inputs > 64)
+            {
+                return std::nullopt;
+            }
+            network.AllInputsMasks.push_back(num_inputs >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << num_inputs) - 1);
+        }
+
+        return network;
     };
-    static constexpr auto to_full_module_state = [](const auto& name_mod)
+    static constexpr auto initial_state = [](const Network& network)
     {
-        return FullModuleState{
-            to_module_state(name_mod.second),
-            name_mod.second.LastSignals,
+        return NetworkState{
+            std::vector<uint64_t>((network.Types.size() + 63) / 64, 0),
+            std::vector<uint64_t>(network.Types.size(), 0),
         };
     };
 
-    const std::string_view input_file{ argv[1] };
-    const std::string file_data{ algo::read_whole_file(input_file) };
-
-    ModuleMap modules{ file_data | lines | to_string_views | to_modules | to_unordered_map };
-
-    // Resolve inputs to conjunction modules
-    for (auto& [name, mod] : modules)
+    // Sends a pulse and handles everything it sets off, on_pulse gets to see each pulse before it is handled
+    // and may drop it by returning false
+    PulseQueue pulse_queue{};
+    const auto send_pulse = [&pulse_queue](const Network& network, NetworkState& state, Pulse first_pulse, auto&& on_pulse)
     {
-        for (auto out : mod.Outputs)
+        pulse_queue.push(first_pulse);
+        while (!pulse_queue.empty())
         {
-            auto it{ modules.find(out) };
-            if (it != modules.end())
+            const Pulse pulse{ pulse_queue.pop() };
+            if (!on_pulse(pulse))
+            {
+                continue;
+            }
+
+            using enum ModuleType;
+            using enum Signal;
+
+            const uint32_t to{ pulse.To };
+            Signal out_sig{ pulse.Sig };
+            switch (network.Types[to])
+            {
+            case Input:
+                break;
+            case FlipFlop:
             {
-                auto& out_mod{ it->second };
-                if (out_mod.Type == ModuleType::Conjunction)
+                if (pulse.Sig == High)
                 {
-                    out_mod.Inputs.push_back(name);
-                    out_mod.LastSignals.push_back(Signal::Low);
+                    continue;
                 }
+                uint64_t& flip_flops{ state.FlipFlops[to / 64] };
+                const uint64_t flip_flop{ uint64_t{ 1 } << (to % 64) };
+                flip_flops ^= flip_flop;
+                out_sig = (flip_flops & flip_flop) != 0 ? High : Low;
+                break;
+            }
+            case Conjunction:
+            {
+                uint64_t& high_inputs{ state.HighInputs[to] };
+                const uint64_t input{ uint64_t{ 1 } << pulse.Slot };
+                high_inputs = pulse.Sig == High ? high_inputs | input : high_inputs & ~input;
+                out_sig = high_inputs == network.AllInputsMasks[to] ? Low : High;
+                break;
+            }
+            case Output:
+            default:
+                continue;
+            }
+
+            for (uint32_t i = network.OutputOffsets[to]; i < network.OutputOffsets[to + 1]; i++)
+            {
+                pulse_queue.push(Pulse{ network.Outputs[i], network.OutputSlots[i], out_sig });
             }
         }
+    };
+
+    const std::string_view input_file{ argv[1] };
+    const std::string file_data{ algo::read_whole_file(input_file) };
+
+    const ModuleMap modules{ file_data | lines | to_string_views | to_modules | to_unordered_map };
+    const std::optional<Network> compiled_network{ compile_network(modules) };
+    if (!compiled_network)
+    {
+        fmt::print("Conjunctions with more than 64 inputs are not supported");
+        return 1;
     }
+    const Network& network{ compiled_network.value() };
 
-    // We have 4 sub-trees, starting at xk, cn, rj, gf
-    //          if we ignore outputs of rz, mr, kv, jg respectively
-    struct SubTree
+    const uint32_t num_modules{ static_cast<uint32_t>(network.Types.size()) };
+    const auto outputs_of = [&](uint32_t mod)
     {
-        std::string_view Root;
-        std::string_view Output;
-    };
-    const std::array subtrees{
-        SubTree{ "xk", "rz" },
-        SubTree{ "cn", "mr" },
-        SubTree{ "rj", "kv" },
-        SubTree{ "gf", "jg" },
+        return std::span{ network.Outputs }.subspan(network.OutputOffsets[mod], network.OutputOffsets[mod + 1] - network.OutputOffsets[mod]);
     };
 
-    // Find the loops for each subtree
-    struct SubtreeLoops
+    // rx is fed by a single conjunction, so it gets a low pulse in exactly those presses during which
+    // every input of that conjunction sends a high pulse to it
+    const uint32_t broadcaster{ network.Ids.at("broadcaster") };
+    const uint32_t rx{ network.Ids.at("rx") };
+    std::vector<uint32_t> rx_inputs;
+    for (uint32_t mod = 0; mod < num_modules; mod++)
     {
-        size_t Start;
-        size_t Length;
-    };
-    std::vector<SubtreeLoops> loops{};
-    for (const auto& [root, output] : subtrees)
+        if (algo::contains(outputs_of(mod), rx))
+        {
+            rx_inputs.push_back(mod);
+        }
+    }
+    if (rx_inputs.size() != 1 || network.Types[rx_inputs.front()] != ModuleType::Conjunction)
     {
-        ModuleMap subtree{};
-        auto build_subtree = [&](this const auto& self, auto mod_name)
+        fmt::print("Expected rx to be fed by exactly one conjunction");
+        return 1;
+    }
+    const uint32_t final_conjunction{ rx_inputs.front() };
+
+    // The sub-circuits are whatever stays connected once the broadcaster, the final conjunction and rx
+    // are taken out of the network, they only talk to each other through the final conjunction
+    std::vector<std::vector<uint32_t>> neighbours(num_modules);
+    for (uint32_t mod = 0; mod < num_modules; mod++)
+    {
+        for (const uint32_t out : outputs_of(mod))
+        {
+            neighbours[mod].push_back(out);
+            neighbours[out].push_back(mod);
+        }
+    }
+
+    static constexpr uint32_t c_NoCircuit{ std::numeric_limits<uint32_t>::max() };
+    std::vector<uint32_t> circuit_of(num_modules, c_NoCircuit);
+    std::vector<uint32_t> circuit_roots;
+    for (const uint32_t root : outputs_of(broadcaster))
+    {
+        if (circuit_of[root] != c_NoCircuit)
+        {
+            continue;
+        }
+
+        const uint32_t circuit{ static_cast<uint32_t>(circuit_roots.size()) };
+        circuit_roots.push_back(root);
+
+        std::vector<uint32_t> to_visit{ root };
+        while (!to_visit.empty())
         {
-            if (subtree.contains(mod_name))
+            const uint32_t mod{ to_visit.back() };
+            to_visit.pop_back();
+            if (circuit_of[mod] != c_NoCircuit || mod == broadcaster || mod == final_conjunction || mod == rx)
             {
-                return;
+                continue;
             }
 
-            auto it{ modules.find(mod_name) };
-            if (it != modules.end())
+            circuit_of[mod] = circuit;
+            to_visit.insert(to_visit.end(), neighbours[mod].begin(), neighbours[mod].end());
+        }
+    }
+
+    static constexpr auto hash_state = [](const NetworkState& state)
+    {
+        // All words of the state hashed as if they were one run
+        using WordsHash = FlatMapHash<std::span<const uint64_t>>;
+        return WordsHash{}(state.HighInputs, WordsHash{}(state.FlipFlops));
+    };
+
+    // Find the loop of each sub-circuit by pressing the button with everything outside of it cut off,
+    // and remember during which presses all its inputs to the final conjunction were high at once
+    struct CircuitLoop : Cycle
+    {
+        std::vector<bool> HighPresses;
+
+        // Press number press starts from the state after press - 1 presses
+        bool is_high(size_t press) const
+        {
+            return HighPresses[equivalent_step(press - 1) + 1];
+        }
+    };
+    std::vector<CircuitLoop> loops{};
+    for (uint32_t circuit = 0; circuit < circuit_roots.size(); circuit++)
+    {
+        uint64_t circuit_slots{ 0 };
+        for (uint32_t mod = 0; mod < num_modules; mod++)
+        {
+            for (uint32_t i = network.OutputOffsets[mod]; i < network.OutputOffsets[mod + 1]; i++)
             {
-                auto& mod{ it->second };
-                subtree[mod_name] = mod;
-                if (mod_name != output)
+                if (circuit_of[mod] == circuit && network.Outputs[i] == final_conjunction)
                 {
-                    for (auto& out : mod.Outputs)
-                    {
-                        self(out);
-                    }
+                    circuit_slots |= uint64_t{ 1 } << network.OutputSlots[i];
                 }
             }
-        };
-        build_subtree(root);
+        }
 
-        std::vector<ModuleStateList> seen_states;
-        size_t loop_start{ 0 };
-        size_t loop_len{ 0 };
-        while (true)
+        // Pulses to the final conjunction still update its inputs, so that a press only counts if all
+        // inputs of this sub-circuit are high at the same time. Its inputs stay part of the state and
+        // are thus hashed and compared along with the sub-circuit
+        uint64_t* final_inputs{ nullptr };
+        bool all_high{ false };
+        const auto stay_in_circuit = [&](const Pulse& pulse)
         {
+            if (pulse.To == final_conjunction)
             {
-                // Detect loop
-                ModuleStateList states{ subtree | std::views::transform(to_full_module_state) | to_vector };
-                if (const ModuleStateList * old{ algo::find(seen_states, states) })
-                {
-                    loop_start = static_cast<size_t>(old - &seen_states.front());
-                    loop_len = static_cast<size_t>(seen_states.size() - loop_start);
-                    break;
-                }
-                seen_states.push_back(states);
+                const uint64_t input{ uint64_t{ 1 } << pulse.Slot };
+                *final_inputs = pulse.Sig == Signal::High ? *final_inputs | input : *final_inputs & ~input;
+                all_high = all_high || (*final_inputs & circuit_slots) == circuit_slots;
             }
+            return pulse.To == broadcaster || circuit_of[pulse.To] == circuit;
+        };
+
+        std::vector<bool> high_presses{ false };
+        const auto press_button = [&](NetworkState& state)
+        {
+            final_inputs = &state.HighInputs[final_conjunction];
+            all_high = false;
+            send_pulse(network, state, Pulse{ broadcaster, 0, Signal::Low }, stay_in_circuit);
+            high_presses.push_back(all_high);
+        };
+        const Cycle loop{ algo::find_cycle(initial_state(network), press_button, hash_state) };
+        loops.push_back({ loop, std::move(high_presses) });
+
+        fmt::print("Sub-circuit @{} loops from {} with loop length {}\n", network.Names[circuit_roots[circuit]], loops.back().Start, loops.back().Length);
+    }
+
+    // Presses before all sub-circuits are in their loops are simply checked one by one
+    const size_t all_looping{ algo::max_element(loops, &CircuitLoop::Start).Start + 1 };
+    std::optional<int64_t> num_buttons_needed{ std::nullopt };
+    for (size_t press = 1; press < all_looping && !num_buttons_needed; press++)
+    {
+        if (algo::all_of(loops, [=](const CircuitLoop& loop)
+                         { return loop.is_high(press); }))
+        {
+            num_buttons_needed = static_cast<int64_t>(press);
+        }
+    }
+
+    // After that each sub-circuit is high on fixed residues modulo its loop length, so combine all of
+    // them with the Chinese remainder theorem for moduli that need not be coprime
+    struct Congruence
+    {
+        int64_t Remainder;
+        int64_t Modulus;
+    };
+    static constexpr auto combine = [](Congruence lhs, Congruence rhs) -> std::optional<Congruence>
+    {
+        int64_t gcd{ lhs.Modulus };
+        int64_t bezout{ 1 };
+        for (int64_t r{ rhs.Modulus }, s{ 0 }; r != 0;)
+        {
+            const int64_t quotient{ gcd / r };
+            gcd = std::exchange(r, gcd - quotient * r);
+            bezout = std::exchange(s, bezout - quotient * s);
+        }
+
+        const int64_t difference{ rhs.Remainder - lhs.Remainder };
+        if (difference % gcd != 0)
+        {
+            return std::nullopt;
+        }
+
+        const int64_t lcm{ lhs.Modulus / gcd * rhs.Modulus };
+        const int128_t steps{ int128_t{ difference / gcd } * int128_t{ bezout } % int128_t{ rhs.Modulus / gcd } };
+        int128_t remainder{ (int128_t{ lhs.Remainder } + int128_t{ lhs.Modulus } * steps) % int128_t{ lcm } };
+        if (remainder < 0)
+        {
+            remainder += lcm;
+        }
+        return Congruence{ static_cast<int64_t>(remainder), lcm };
+    };
 
-            // Enter the subtree by sending the low pulse from the broadcaster
-            PendingSignalList pending_signals{ { "broadcaster", root, Signal::Low } };
-            while (!pending_signals.empty())
+    std::vector<Congruence> candidates{ Congruence{ 0, 1 } };
+    for (const CircuitLoop& loop : loops)
+    {
+        std::vector<Congruence> next_candidates;
+        for (size_t press = loop.Start + 1; press <= loop.Start + loop.Length; press++)
+        {
+            if (loop.HighPresses[press])
             {
-                PendingSignalList next_signals{};
-                for (auto [from, to, signal] : pending_signals)
+                const Congruence residue{ static_cast<int64_t>(press % loop.Length), static_cast<int64_t>(loop.Length) };
+                for (const Congruence& candidate : candidates)
                 {
-                    using enum ModuleType;
-                    using enum Signal;
-                    using enum ModuleState;
-
-                    // Sometimes we send signals into the void, these are output-only nodes
-                    auto it{ subtree.find(to) };
-                    if (it != subtree.end())
+                    if (const auto combined{ combine(candidate, residue) })
                     {
-                        auto& to_mod{ it->second };
-                        switch (to_mod.Type)
-                        {
-                        case FlipFlop:
-                            if (signal == Low)
-                            {
-                                to_mod.State = to_mod.State == On ? Off : On;
-                                const auto out_sig{ to_mod.State == On ? High : Low };
-                                for (auto& out : to_mod.Outputs)
-                                {
-                                    next_signals.push_back({ to, out, out_sig });
-                                }
-                            }
-                            break;
-                        case Conjunction:
-                        {
-                            const auto prev_state{ to_module_state(to_mod) };
-                            for (auto [out, last_sig] : std::views::zip(to_mod.Inputs, to_mod.LastSignals))
-                            {
-                                if (out == from)
-                                {
-                                    last_sig = signal;
-                                }
-                            }
-                            const auto next_state{ to_module_state(to_mod) };
-                            const auto out_sig{ next_state == On ? Low : High };
-                            for (auto& out : to_mod.Outputs)
-                            {
-                                next_signals.push_back({ to, out, out_sig });
-                            }
-
-                            if (to == output && prev_state != next_state)
-                            {
-                                // Printing to verify that this switches at the end of the loop
-                                fmt::print("{} from {} to {} @{}\n", output, prev_state == On ? "ON" : "OFF", next_state == On ? "ON" : "OFF", seen_states.size());
-                            }
-                            break;
-                        }
-                        case Input:
-                            // No input nodes in the subtrees, cleans up code
-                        case Output:
-                        default:
-                            break;
-                        }
+                        next_candidates.push_back(combined.value());
                     }
                 }
-
-                std::swap(pending_signals, next_signals);
             }
         }
-
-        // Printing to verify that loops start out at 0
-        fmt::print("Subtree @{} loops from {} with loop length {}\n", root, loop_start, loop_len);
-        loops.push_back({ loop_start, loop_len });
+        candidates = std::move(next_candidates);
     }
 
-    // Get the loop for the combined tree
-    // Note: This breaks for the loops don't start at 0
-    size_t num_buttons_needed{ loops[0].Length };
-    for (auto loop : loops | std::views::drop(1))
+    for (const auto& [remainder, modulus] : candidates)
     {
-        num_buttons_needed = std::lcm(num_buttons_needed, loop.Length);
+        const int64_t first_press{ static_cast<int64_t>(all_looping) };
+        const int64_t press{ remainder >= first_press
+                                 ? remainder
+                                 : remainder + (first_press - remainder + modulus - 1) / modulus * modulus };
+        if (!num_buttons_needed || press < num_buttons_needed.value())
+        {
+            num_buttons_needed = press;
+        }
     }
-    fmt::print("The result is: {}", num_buttons_needed);
-    return num_buttons_needed != 238420328103151;
+
+    fmt::print("The result is: {}", num_buttons_needed.value_or(0));
+    return num_buttons_needed.value_or(0) != 238420328103151;
 }
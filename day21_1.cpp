@@ -1,41 +1,12 @@
 ﻿#include <cctype>
 #include <compare>
-#include <queue>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
-
-struct Vec2
-{
-    int64_t X;
-    int64_t Y;
-
-    auto operator<=>(const Vec2&) const = default;
-
-    Vec2 operator*(const int64_t& rhs) const
-    {
-        return Vec2{ X * rhs, Y * rhs };
-    }
-    Vec2 operator+(const Vec2& rhs) const
-    {
-        return Vec2{ X + rhs.X, Y + rhs.Y };
-    }
-    Vec2 operator-(const Vec2& rhs) const
-    {
-        return Vec2{ X - rhs.X, Y - rhs.Y };
-    }
-    Vec2 rot_left() const
-    {
-        return Vec2{ Y, -X };
-    }
-    Vec2 rot_right() const
-    {
-        return Vec2{ -Y, X };
-    }
-};
+#include "garden_walk.h"
 
 int main(int argc, char** argv)
 {
@@ -75,47 +46,10 @@ int main(int argc, char** argv)
         }()
     };
 
-    const Vec2 garden_min{ 0, 0 };
-    const Vec2 garden_max{ static_cast<int64_t>(garden.front().size()), static_cast<int64_t>(garden.size()) };
-    const auto out_of_bounds = [&](const auto& coord)
-    {
-        const auto& [x, y] = coord;
-        return x < garden_min.X ||
-               y < garden_min.Y ||
-               x >= garden_max.X ||
-               y >= garden_max.Y;
-    };
-
-    std::vector positions{ starting_pos };
-    for (size_t i = 0; i < 64; i++)
-    {
-        std::vector<Vec2> next_positions;
-        for (const auto& [x, y] : positions)
-        {
-            const Vec2 top{ x, y - 1 };
-            const Vec2 bot{ x, y + 1 };
-            const Vec2 lef{ x - 1, y };
-            const Vec2 rig{ x + 1, y };
-
-            const auto try_push = [&](Vec2 pos)
-            {
-                using namespace std::string_view_literals;
-                if (!out_of_bounds(pos) &&
-                    ".S"sv.contains(garden[pos.Y][pos.X]) &&
-                    !algo::contains(next_positions, pos))
-                {
-                    next_positions.push_back(pos);
-                }
-            };
-            try_push(top);
-            try_push(bot);
-            try_push(lef);
-            try_push(rig);
-        }
-        std::swap(positions, next_positions);
-    }
+    GardenWalk walk{ garden, 1, starting_pos };
+    walk.step(64);
 
-    size_t num_final_positions{ positions.size() };
+    const int64_t num_final_positions{ walk.count_reachable() };
     fmt::print("The result is: {}", num_final_positions);
     return num_final_positions != 3632;
 }
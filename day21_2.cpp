@@ -1,48 +1,20 @@
-#include <cassert>
 #include <cctype>
 #include <compare>
-#include <queue>
+#include <numeric>
+#include <optional>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
-
-struct Vec2
-{
-    int64_t X;
-    int64_t Y;
-
-    auto operator<=>(const Vec2&) const = default;
-
-    Vec2 operator*(const int64_t& rhs) const
-    {
-        return Vec2{ X * rhs, Y * rhs };
-    }
-    Vec2 operator+(const Vec2& rhs) const
-    {
-        return Vec2{ X + rhs.X, Y + rhs.Y };
-    }
-    Vec2 operator-(const Vec2& rhs) const
-    {
-        return Vec2{ X - rhs.X, Y - rhs.Y };
-    }
-    Vec2 rot_left() const
-    {
-        return Vec2{ Y, -X };
-    }
-    Vec2 rot_right() const
-    {
-        return Vec2{ -Y, X };
-    }
-};
+#include "garden_walk.h"
 
 int main(int argc, char** argv)
 {
-    if (argc != 2)
+    if (argc != 2 && argc != 3)
     {
-        fmt::print("Usage is exactly: *.exe input.txt");
+        fmt::print("Usage is exactly: *.exe input.txt [num_steps]");
         return 1;
     }
 
@@ -56,7 +28,6 @@ int main(int argc, char** argv)
     const std::string file_data{ algo::read_whole_file(input_file) };
 
     const std::vector garden{ file_data | lines | to_string_views | to_vector };
-    const Vec2 garden_min{ 0, 0 };
     const Vec2 garden_max{ static_cast<int64_t>(garden.front().size()), static_cast<int64_t>(garden.size()) };
 
     const Vec2 starting_pos{
@@ -76,136 +47,115 @@ int main(int argc, char** argv)
         }()
     };
 
-    // Have to be in the exact center of an uneven-sized garden
-    assert(starting_pos.X == starting_pos.Y);
-    assert(starting_pos.X % 2 == 1);
-    assert(garden_max.X == garden_max.Y);
-    assert(garden_max.X % 2 == 1);
-    assert(starting_pos.X == garden_max.X / 2);
+    static constexpr int64_t c_DefaultNumSteps{ 26501365 };
+    const int64_t num_steps{ argc == 3 ? algo::stoi<int64_t>(argv[2]) : c_DefaultNumSteps };
 
-    const auto modulo_bounds = [&](Vec2 coord)
+    // Enough copies that the walk never leaves the approximated garden
+    const auto num_copies_for = [&](int64_t max_steps)
     {
-        const auto& [x, y] = coord;
-        const auto& [X, Y] = garden_max;
-        auto [nx, ny] = coord;
-
-        return std::pair{
-            Vec2{
-                ((nx %= X) < 0) ? nx + X : nx,
-                ((ny %= Y) < 0) ? ny + Y : ny,
-            },
-            Vec2{
-                (x + (x < 0 ? 1 : 0)) / X - (x < 0 ? 1 : 0),
-                (y + (y < 0 ? 1 : 0)) / Y - (y < 0 ? 1 : 0),
-            },
-        };
+        return 2 * (max_steps / std::min(garden_max.X, garden_max.Y) + 1) + 1;
     };
+    const auto walk_steps = [&](const std::vector<int64_t>& sample_steps)
+    {
+        GardenWalk walk{ garden, num_copies_for(sample_steps.back()), starting_pos };
 
-    using WrappingTile = std::array<std::array<bool, 9>, 9>;
-    std::vector steps(garden_max.Y, std::vector(garden_max.X, WrappingTile{}));
-    steps[starting_pos.Y][starting_pos.X][0 + 4][0 + 4] = true;
+        std::vector<int64_t> reachable;
+        for (const int64_t steps : sample_steps)
+        {
+            walk.step(steps - walk.num_steps());
+            reachable.push_back(walk.count_reachable());
+        }
+        return reachable;
+    };
 
-    static constexpr int64_t c_NumSteps{ 26501365 };
-    const int64_t steps_to_fill_first_square{ garden_max.X };
-    const int64_t num_multiples_of_first_square{ c_NumSteps / steps_to_fill_first_square };
-    const int64_t num_extra_steps{ c_NumSteps % steps_to_fill_first_square };
-    const int64_t num_explicit_steps{ 3 * steps_to_fill_first_square + num_extra_steps };
+    // Bitboards of more plots than this take hundreds of megabytes and minutes to walk
+    static constexpr int64_t c_MaxWalkPlots{ int64_t{ 1 } << 28 };
+    const auto fits_walk = [&](int64_t max_steps)
+    {
+        const int64_t num_copies{ num_copies_for(max_steps) };
+        const int64_t num_plots{ garden_max.X * num_copies * garden_max.Y * num_copies };
+        if (num_plots > c_MaxWalkPlots)
+        {
+            fmt::print("Walking {} steps needs {}x{} copies of the garden, that is too large\n", max_steps, num_copies, num_copies);
+            return false;
+        }
+        return true;
+    };
 
-    const auto do_steps = [&](int64_t n)
+    // Once the walk spreads over whole copies of the garden, the number of reachable plots after
+    // n + k * stride steps grows quadratically in k. Sample that until the second differences settle,
+    // taking more samples if they don't, and extrapolate from the last sample
+    static constexpr size_t c_NumStableDifferences{ 3 };
+    static constexpr size_t c_MaxSamples{ 64 };
+    const auto extrapolate = [&](int64_t stride) -> std::optional<int64_t>
     {
-        for (int64_t i = 0; i < n; i++)
+        const int64_t first_sample{ num_steps % stride };
+        for (size_t num_samples = c_NumStableDifferences + 2; num_samples <= c_MaxSamples; num_samples *= 2)
         {
-            std::vector next_steps(garden_max.Y, std::vector(garden_max.X, WrappingTile{}));
-            const auto step_to = [&](Vec2 tile, Vec2 to)
+            std::vector<int64_t> sample_steps;
+            for (size_t k = 0; k < num_samples; k++)
             {
-                using namespace std::string_view_literals;
+                sample_steps.push_back(first_sample + static_cast<int64_t>(k) * stride);
+            }
 
-                const auto [mod_to, tile_to] = modulo_bounds(to);
-                if (".S"sv.contains(garden[mod_to.Y][mod_to.X]))
+            if (num_steps <= sample_steps.back())
+            {
+                if (!fits_walk(num_steps))
                 {
-                    const Vec2 final_tile{ tile + tile_to };
-                    next_steps[mod_to.Y][mod_to.X][final_tile.Y + 4][final_tile.X + 4] = true;
+                    return std::nullopt;
                 }
-            };
+                return walk_steps({ num_steps }).front();
+            }
+            if (!fits_walk(sample_steps.back()))
+            {
+                return std::nullopt;
+            }
 
-            for (int64_t x = 0; x < garden_max.X; x++)
+            const std::vector reachable{ walk_steps(sample_steps) };
+            const auto second_difference = [&](size_t k)
             {
-                for (int64_t y = 0; y < garden_max.Y; y++)
+                return reachable[k] - 2 * reachable[k - 1] + reachable[k - 2];
+            };
+            const bool is_quadratic{
+                [&]()
                 {
-                    const Vec2 cur{ x, y };
-                    const Vec2 top{ x, y - 1 };
-                    const Vec2 bot{ x, y + 1 };
-                    const Vec2 lef{ x - 1, y };
-                    const Vec2 rig{ x + 1, y };
-
-                    for (int64_t tx = -3; tx <= 3; tx++)
+                    for (size_t k = num_samples - c_NumStableDifferences + 1; k < num_samples; k++)
                     {
-                        for (int64_t ty = -3; ty <= 3; ty++)
+                        if (second_difference(k) != second_difference(k - 1))
                         {
-                            if (steps[y][x][ty + 4][tx + 4])
-                            {
-                                const Vec2 tile{ tx, ty };
-                                step_to(tile, top);
-                                step_to(tile, bot);
-                                step_to(tile, lef);
-                                step_to(tile, rig);
-                            }
+                            return false;
                         }
                     }
-                }
+                    return true;
+                }()
+            };
+            if (is_quadratic)
+            {
+                const int64_t remaining_strides{ (num_steps - sample_steps.back()) / stride };
+                const int64_t first_difference{ reachable[num_samples - 1] - reachable[num_samples - 2] };
+                return reachable.back() +
+                       remaining_strides * first_difference +
+                       remaining_strides * (remaining_strides + 1) / 2 * second_difference(num_samples - 1);
             }
-            std::swap(steps, next_steps);
         }
+        return std::nullopt;
     };
-    do_steps(num_explicit_steps);
 
-    const auto count_square = [&](Vec2 square_pos)
+    // With an odd period consecutive samples alternate in parity, and the plots reachable in an even and an
+    // odd number of steps need not follow the same quadratic, so fall back to sampling every other period
+    const int64_t period{ std::lcm(garden_max.X, garden_max.Y) };
+    std::optional<int64_t> num_final_positions{ extrapolate(period) };
+    if (!num_final_positions)
     {
-        int64_t cnt{ 0 };
-        for (int64_t x = 0; x < garden_max.X; x++)
-        {
-            for (int64_t y = 0; y < garden_max.Y; y++)
-            {
-                cnt += steps[y][x][square_pos.Y + 4][square_pos.X + 4] ? 1 : 0;
-            }
-        }
-        fmt::print("{{ {}, {} }} -> {}\n", square_pos.X, square_pos.Y, cnt);
-        return cnt;
-    };
+        num_final_positions = extrapolate(2 * period);
+    }
 
-    const int64_t filled_odd_square{ count_square({ 0, 0 }) };
-    const int64_t filled_even_square{ count_square({ 0, 1 }) };
-    assert(filled_even_square == count_square({ 0, -1 }));
-    assert(filled_even_square == count_square({ 1, 0 }));
-    assert(filled_even_square == count_square({ -1, 0 }));
-
-    const int64_t top_square{ count_square({ 0, -3 }) };
-    const int64_t bot_square{ count_square({ 0, +3 }) };
-    const int64_t lef_square{ count_square({ -3, 0 }) };
-    const int64_t rig_square{ count_square({ +3, 0 }) };
-
-    const int64_t nne_square{ count_square({ +2, +2 }) };
-    const int64_t nee_square{ count_square({ +2, +1 }) };
-    const int64_t nnw_square{ count_square({ -2, +2 }) };
-    const int64_t nww_square{ count_square({ -2, +1 }) };
-    const int64_t sse_square{ count_square({ +2, -2 }) };
-    const int64_t see_square{ count_square({ +2, -1 }) };
-    const int64_t ssw_square{ count_square({ -2, -2 }) };
-    const int64_t sww_square{ count_square({ -2, -1 }) };
-
-    const int64_t k{ num_multiples_of_first_square };
-    int64_t num_filled_odd_squares{ k * k };              // WolframAlpha math
-    int64_t num_filled_even_squares{ (k - 1) * (k - 1) }; // WolframAlpha math
-    int64_t num_parial_type_one{ k };                     // These go along the whole exposed edge
-    int64_t num_parial_type_two{ k - 1 };                 // These are stopped by the corners
-
-    int64_t num_final_positions{
-        num_filled_odd_squares * filled_odd_square +
-        num_filled_even_squares * filled_even_square +
-        top_square + bot_square + lef_square + rig_square +
-        num_parial_type_one * (nne_square + nnw_square + sse_square + ssw_square) +
-        num_parial_type_two * (nee_square + nww_square + see_square + sww_square)
-    };
-    fmt::print("The result is: {}", num_final_positions);
-    return num_final_positions != 600336060511101;
+    if (!num_final_positions)
+    {
+        fmt::print("Number of reachable plots does not grow quadratically");
+        return 1;
+    }
+
+    fmt::print("The result is: {}", num_final_positions.value());
+    return num_steps == c_DefaultNumSteps && num_final_positions.value() != 600336060511101;
 }
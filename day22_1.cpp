@@ -1,7 +1,8 @@
-﻿#include <cassert>
+﻿#include <algorithm>
+#include <cassert>
 #include <cctype>
 #include <compare>
-#include <queue>
+#include <limits>
 #include <ranges>
 #include <string_view>
 
@@ -51,44 +52,6 @@ struct Vec3
     }
 };
 
-template<class T>
-struct FlatMultiArrayView
-{
-    int64_t Width;
-    int64_t Depth;
-    int64_t Height;
-    std::span<T> Data;
-
-    template<class SelfT>
-    auto operator[](this SelfT& self, int64_t x)
-    {
-        struct IndexProxyX
-        {
-            SelfT& Self;
-            int64_t X;
-
-            auto operator[](int64_t y)
-            {
-                struct IndexProxyXY
-                {
-                    SelfT& Self;
-                    int64_t X;
-                    int64_t Y;
-
-                    auto& operator[](int64_t z)
-                    {
-                        return Self.Data[X + Y * Self.Width + z * Self.Width * Self.Depth];
-                    }
-                };
-
-                return IndexProxyXY{ Self, X, y };
-            }
-        };
-
-        return IndexProxyX{ self, x };
-    }
-};
-
 struct Brick
 {
     Vec3 From;
@@ -131,7 +94,10 @@ int main(int argc, char** argv)
             [[maybe_unused]] const auto dy{ vecs[0].Y - vecs[1].Y };
             [[maybe_unused]] const auto dz{ vecs[0].Z - vecs[1].Z };
             assert((dx == 0 && dy == 0) || (dx == 0 && dz == 0) || (dy == 0 && dz == 0));
-            return Brick{ vecs[0], vecs[1] };
+            return Brick{
+                Vec3{ std::min(vecs[0].X, vecs[1].X), std::min(vecs[0].Y, vecs[1].Y), std::min(vecs[0].Z, vecs[1].Z) },
+                Vec3{ std::max(vecs[0].X, vecs[1].X), std::max(vecs[0].Y, vecs[1].Y), std::max(vecs[0].Z, vecs[1].Z) },
+            };
         }) };
 
     const std::string_view input_file{ argv[1] };
@@ -139,236 +105,60 @@ int main(int argc, char** argv)
 
     std::vector bricks{ file_data | lines | to_string_views | to_bricks | to_vector };
 
-    const Vec3 world_min{ 0, 0, 0 };
-    const Vec3 world_max{
-        [&bricks]()
-        {
-            Vec3 world_max{ 0, 0, 0 };
-            for (const Brick& brick : bricks)
-            {
-                world_max.X = algo::max(brick.From.X, brick.To.X, world_max.X);
-                world_max.Y = algo::max(brick.From.Y, brick.To.Y, world_max.Y);
-                world_max.Z = algo::max(brick.From.Z, brick.To.Z, world_max.Z);
-            }
-            return world_max;
-        }()
-    };
-
-    static constexpr size_t c_Air{ 0xfefefefefefefefe };
-    static constexpr size_t c_Ground{ 0xffffffffffffffff };
+    // Dropping bricks from the lowest one up means every brick lands on bricks that already settled
+    std::ranges::sort(bricks, {}, [](const Brick& brick)
+                      { return brick.From.Z; });
 
-    const Vec3 world_data_size{ world_max + 1 };
-    std::vector world_data(world_data_size.X * world_data_size.Y * world_data_size.Z, size_t{ c_Air });
-    FlatMultiArrayView<size_t> world{ world_data_size.X, world_data_size.Y, world_data_size.Z, world_data };
-
-    // Initialize ground
-    for (int64_t x = 0; x <= world_max.X; x++)
+    int64_t world_width{ 0 };
+    int64_t world_depth{ 0 };
+    for (const Brick& brick : bricks)
     {
-        for (int64_t y = 0; y <= world_max.Y; y++)
-        {
-            world[x][y][0] = c_Ground;
-        }
+        world_width = std::max(world_width, brick.To.X + 1);
+        world_depth = std::max(world_depth, brick.To.Y + 1);
     }
 
-    // Initialize bricks in world
-    for (const auto& [i, brick] : std::views::enumerate(bricks))
-    {
-        const Vec3 dir{ (brick.To - brick.From).normalized() };
-        Vec3 pos{ brick.From };
-        while (pos != brick.To + dir)
-        {
-            const auto& [x, y, z] = pos;
-            world[x][y][z] = i;
-            pos = pos + dir;
-        }
-    }
+    static constexpr size_t c_Ground{ std::numeric_limits<size_t>::max() };
 
-    // Update bricks until they all settle
-    const auto settle = [&]()
+    // The top of each column of the world and the brick making up that top
+    struct Column
     {
-        while (true)
-        {
-            std::vector settled(bricks.size(), uint8_t{ 0 });
-            for (const auto& [i, brick] : std::views::enumerate(bricks))
-            {
-                const Vec3 from{ brick.From.X, brick.From.Y, std::min(brick.From.Z, brick.To.Z) };
-                const Vec3 to{ brick.To.X, brick.To.Y, std::max(brick.To.Z, brick.From.Z) };
-                const Vec3 dir{ (to - from).normalized() };
-                const Vec3 down{ 0, 0, -1 };
-
-                bool blocked{ false };
-                {
-                    // Check if we cab move
-                    Vec3 pos{ brick.From };
-                    while (pos != to + dir)
-                    {
-                        [[maybe_unused]] const auto here{ world[pos.X][pos.Y][pos.Z] };
-                        assert(here == static_cast<size_t>(i));
-
-                        const Vec3 below{ pos + down };
-                        const size_t i_below{ world[below.X][below.Y][below.Z] };
-                        if (i_below == static_cast<size_t>(i))
-                        {
-                            break;
-                        }
-                        else if (i_below != c_Air)
-                        {
-                            blocked = true;
-                            break;
-                        }
-                        pos = pos + dir;
-                    }
-                }
-
-                if (!blocked)
-                {
-                    Vec3 pos{ brick.From };
-                    while (pos != to + dir)
-                    {
-                        const Vec3 below{ pos + down };
-
-                        [[maybe_unused]] const auto here{ world[pos.X][pos.Y][pos.Z] };
-                        assert(here == static_cast<size_t>(i));
-                        [[maybe_unused]] const auto there{ world[below.X][below.Y][below.Z] };
-                        assert(there == c_Air);
-
-                        world[pos.X][pos.Y][pos.Z] = c_Air;
-                        world[below.X][below.Y][below.Z] = i;
-                        pos = pos + dir;
-                    }
-                    assert(brick.From.Z > 1);
-                    assert(brick.To.Z > 1);
-                    bricks[i] = { brick.From + down, brick.To + down };
-                }
-
-                settled[i] = blocked;
-            }
-            if (algo::all_of(settled))
-            {
-                return;
-            }
-        }
+        int64_t Top;
+        size_t Brick;
     };
+    std::vector height_map(world_width * world_depth, Column{ 0, c_Ground });
 
-    const auto print_xz = [&]()
+    const auto for_each_column = [&](const Brick& brick, auto&& fun)
     {
-        std::string str;
-        for (int64_t zz = 0; zz <= world_max.Z; zz++)
+        for (int64_t y = brick.From.Y; y <= brick.To.Y; y++)
         {
-            const int64_t z = world_max.Z - zz;
-            for (int64_t x = 0; x <= world_max.X; x++)
+            for (int64_t x = brick.From.X; x <= brick.To.X; x++)
             {
-                char c{ ' ' };
-                for (int64_t y = 0; y <= world_max.Y; y++)
-                {
-                    const size_t i{ world[x][y][z] };
-                    if (i == c_Ground)
-                    {
-                        c = '~';
-                        break;
-                    }
-                    else if (i != c_Air)
-                    {
-                        size_t d{ 'A' + i };
-                        if (d > 'Z')
-                        {
-                            d = (d - 'A') % ('Z' - 'A') + 'A';
-                        }
-
-                        char dd{ char(d) };
-                        if (c == ' ')
-                        {
-                            c = dd;
-                        }
-                        else if (c != dd)
-                        {
-                            c = '?';
-                            break;
-                        }
-                    }
-                }
-                str += c;
+                fun(height_map[x + y * world_width]);
             }
-            str += '\n';
         }
-        fmt::print("{}\n", str);
-    };
-    const auto print_yz = [&]()
-    {
-        std::string str;
-        for (int64_t zz = 0; zz <= world_max.Z; zz++)
-        {
-            const int64_t z = world_max.Z - zz;
-            for (int64_t y = 0; y <= world_max.Y; y++)
-            {
-                char c{ ' ' };
-                for (int64_t x = 0; x <= world_max.X; x++)
-                {
-                    const size_t i{ world[x][y][z] };
-                    if (i == c_Ground)
-                    {
-                        c = '~';
-                        break;
-                    }
-                    else if (i != c_Air)
-                    {
-                        size_t d{ 'A' + i };
-                        if (d > 'Z')
-                        {
-                            d = (d - 'A') % ('Z' - 'A') + 'A';
-                        }
-
-                        char dd{ char(d) };
-                        if (c == ' ')
-                        {
-                            c = dd;
-                        }
-                        else if (c != dd)
-                        {
-                            c = '?';
-                            break;
-                        }
-                    }
-                }
-                str += c;
-            }
-            str += '\n';
-        }
-        fmt::print("{}\n", str);
     };
 
-    print_xz();
-    print_yz();
-    settle();
-    print_xz();
-    print_yz();
-
-    // Mark which bricks are supported by which other bricks
-    for (const auto& [i, brick] : std::views::enumerate(bricks))
+    // Drop each brick onto the highest column below it, all bricks topping a column of that height support it
+    for (size_t i = 0; i < bricks.size(); i++)
     {
-        const Vec3 from{ brick.From.X, brick.From.Y, std::min(brick.From.Z, brick.To.Z) };
-        const Vec3 to{ brick.To.X, brick.To.Y, std::max(brick.To.Z, brick.From.Z) };
-        const Vec3 dir{ (to - from).normalized() };
-        const Vec3 up{ 0, 0, 1 };
+        Brick& brick{ bricks[i] };
 
-        Vec3 pos{ brick.From };
-        while (pos != to + dir)
-        {
-            [[maybe_unused]] const auto here{ world[pos.X][pos.Y][pos.Z] };
-            assert(here == static_cast<size_t>(i));
+        int64_t landing{ 0 };
+        for_each_column(brick, [&](const Column& column)
+                        { landing = std::max(landing, column.Top); });
 
-            if (pos.Z < world_max.Z)
+        const int64_t fall{ brick.From.Z - landing - 1 };
+        brick.From.Z -= fall;
+        brick.To.Z -= fall;
+
+        for_each_column(brick, [&](Column& column)
+                        {
+            if (column.Top == landing && column.Brick != c_Ground)
             {
-                const Vec3 above{ pos + up };
-                const size_t i_above{ world[above.X][above.Y][above.Z] };
-                if (i_above != static_cast<size_t>(i) && i_above != c_Air)
-                {
-                    bricks[i].Supports.insert(i_above);
-                    bricks[i_above].SupportedBy.insert(i);
-                }
+                bricks[column.Brick].Supports.insert(i);
+                brick.SupportedBy.insert(column.Brick);
             }
-            pos = pos + dir;
-        }
+            column = Column{ brick.To.Z, i }; });
     }
 
     size_t num_safe_bricks{};
@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cctype>
 #include <compare>
-#include <queue>
+#include <limits>
 #include <ranges>
+#include <span>
 #include <string_view>
 
 #include <fmt/format.h>
@@ -51,51 +54,10 @@ struct Vec3
     }
 };
 
-template<class T>
-struct FlatMultiArrayView
-{
-    int64_t Width;
-    int64_t Depth;
-    int64_t Height;
-    std::span<T> Data;
-
-    template<class SelfT>
-    auto operator[](this SelfT& self, int64_t x)
-    {
-        struct IndexProxyX
-        {
-            SelfT& Self;
-            int64_t X;
-
-            auto operator[](int64_t y)
-            {
-                struct IndexProxyXY
-                {
-                    SelfT& Self;
-                    int64_t X;
-                    int64_t Y;
-
-                    auto& operator[](int64_t z)
-                    {
-                        return Self.Data[X + Y * Self.Width + z * Self.Width * Self.Depth];
-                    }
-                };
-
-                return IndexProxyXY{ Self, X, y };
-            }
-        };
-
-        return IndexProxyX{ self, x };
-    }
-};
-
 struct Brick
 {
     Vec3 From;
     Vec3 To;
-
-    std::set<size_t> Supports;
-    std::set<size_t> SupportedBy;
 };
 
 int main(int argc, char** argv)
@@ -131,7 +93,10 @@ int main(int argc, char** argv)
             [[maybe_unused]] const auto dy{ vecs[0].Y - vecs[1].Y };
             [[maybe_unused]] const auto dz{ vecs[0].Z - vecs[1].Z };
             assert((dx == 0 && dy == 0) || (dx == 0 && dz == 0) || (dy == 0 && dz == 0));
-            return Brick{ vecs[0], vecs[1] };
+            return Brick{
+                Vec3{ std::min(vecs[0].X, vecs[1].X), std::min(vecs[0].Y, vecs[1].Y), std::min(vecs[0].Z, vecs[1].Z) },
+                Vec3{ std::max(vecs[0].X, vecs[1].X), std::max(vecs[0].Y, vecs[1].Y), std::max(vecs[0].Z, vecs[1].Z) },
+            };
         }) };
 
     const std::string_view input_file{ argv[1] };
@@ -139,261 +104,137 @@ int main(int argc, char** argv)
 
     std::vector bricks{ file_data | lines | to_string_views | to_bricks | to_vector };
 
-    const Vec3 world_min{ 0, 0, 0 };
-    const Vec3 world_max{
-        [&bricks]()
-        {
-            Vec3 world_max{ 0, 0, 0 };
-            for (const Brick& brick : bricks)
-            {
-                world_max.X = algo::max(brick.From.X, brick.To.X, world_max.X);
-                world_max.Y = algo::max(brick.From.Y, brick.To.Y, world_max.Y);
-                world_max.Z = algo::max(brick.From.Z, brick.To.Z, world_max.Z);
-            }
-            return world_max;
-        }()
-    };
-
-    static constexpr size_t c_Air{ 0xfefefefefefefefe };
-    static constexpr size_t c_Ground{ 0xffffffffffffffff };
-
-    const Vec3 world_data_size{ world_max + 1 };
-    std::vector world_data(world_data_size.X * world_data_size.Y * world_data_size.Z, size_t{ c_Air });
-    FlatMultiArrayView<size_t> world{ world_data_size.X, world_data_size.Y, world_data_size.Z, world_data };
+    // Dropping bricks from the lowest one up means every brick lands on bricks that already settled
+    std::ranges::sort(bricks, {}, [](const Brick& brick)
+                      { return brick.From.Z; });
 
-    // Initialize ground
-    for (int64_t x = 0; x <= world_max.X; x++)
+    int64_t world_width{ 0 };
+    int64_t world_depth{ 0 };
+    for (const Brick& brick : bricks)
     {
-        for (int64_t y = 0; y <= world_max.Y; y++)
-        {
-            world[x][y][0] = c_Ground;
-        }
+        world_width = std::max(world_width, brick.To.X + 1);
+        world_depth = std::max(world_depth, brick.To.Y + 1);
     }
 
-    // Initialize bricks in world
-    for (const auto& [i, brick] : std::views::enumerate(bricks))
+    static constexpr size_t c_Ground{ std::numeric_limits<size_t>::max() };
+
+    // The top of each column of the world and the brick making up that top
+    struct Column
     {
-        const Vec3 dir{ (brick.To - brick.From).normalized() };
-        Vec3 pos{ brick.From };
-        while (pos != brick.To + dir)
-        {
-            const auto& [x, y, z] = pos;
-            world[x][y][z] = i;
-            pos = pos + dir;
-        }
-    }
+        int64_t Top;
+        size_t Brick;
+    };
+    std::vector height_map(world_width * world_depth, Column{ 0, c_Ground });
 
-    // Update bricks until they all settle
-    const auto settle = [&]()
+    const auto for_each_column = [&](const Brick& brick, auto&& fun)
     {
-        while (true)
+        for (int64_t y = brick.From.Y; y <= brick.To.Y; y++)
         {
-            std::vector settled(bricks.size(), uint8_t{ 0 });
-            for (const auto& [i, brick] : std::views::enumerate(bricks))
+            for (int64_t x = brick.From.X; x <= brick.To.X; x++)
             {
-                const Vec3 from{ brick.From.X, brick.From.Y, std::min(brick.From.Z, brick.To.Z) };
-                const Vec3 to{ brick.To.X, brick.To.Y, std::max(brick.To.Z, brick.From.Z) };
-                const Vec3 dir{ (to - from).normalized() };
-                const Vec3 down{ 0, 0, -1 };
-
-                bool blocked{ false };
-                {
-                    // Check if we cab move
-                    Vec3 pos{ brick.From };
-                    while (pos != to + dir)
-                    {
-                        [[maybe_unused]] const auto here{ world[pos.X][pos.Y][pos.Z] };
-                        assert(here == static_cast<size_t>(i));
-
-                        const Vec3 below{ pos + down };
-                        const size_t i_below{ world[below.X][below.Y][below.Z] };
-                        if (i_below == static_cast<size_t>(i))
-                        {
-                            break;
-                        }
-                        else if (i_below != c_Air)
-                        {
-                            blocked = true;
-                            break;
-                        }
-                        pos = pos + dir;
-                    }
-                }
+                fun(height_map[x + y * world_width]);
+            }
+        }
+    };
 
-                if (!blocked)
-                {
-                    Vec3 pos{ brick.From };
-                    while (pos != to + dir)
-                    {
-                        const Vec3 below{ pos + down };
+    // Drop each brick onto the highest column below it, all bricks topping a column of that height support it.
+    // Supports of a brick are always dropped before it, so they are stored in brick order as flat arrays
+    std::vector<size_t> supported_by_offsets{ 0 };
+    std::vector<size_t> supported_by;
+    for (size_t i = 0; i < bricks.size(); i++)
+    {
+        Brick& brick{ bricks[i] };
 
-                        [[maybe_unused]] const auto here{ world[pos.X][pos.Y][pos.Z] };
-                        assert(here == static_cast<size_t>(i));
-                        [[maybe_unused]] const auto there{ world[below.X][below.Y][below.Z] };
-                        assert(there == c_Air);
+        int64_t landing{ 0 };
+        for_each_column(brick, [&](const Column& column)
+                        { landing = std::max(landing, column.Top); });
 
-                        world[pos.X][pos.Y][pos.Z] = c_Air;
-                        world[below.X][below.Y][below.Z] = i;
-                        pos = pos + dir;
-                    }
-                    assert(brick.From.Z > 1);
-                    assert(brick.To.Z > 1);
-                    bricks[i] = { brick.From + down, brick.To + down };
-                }
+        const int64_t fall{ brick.From.Z - landing - 1 };
+        brick.From.Z -= fall;
+        brick.To.Z -= fall;
 
-                settled[i] = blocked;
-            }
-            if (algo::all_of(settled))
+        for_each_column(brick, [&](Column& column)
+                        {
+            const bool new_support{
+                column.Top == landing &&
+                column.Brick != c_Ground &&
+                !algo::contains(std::span{ supported_by }.subspan(supported_by_offsets.back()), column.Brick)
+            };
+            if (new_support)
             {
-                return;
+                supported_by.push_back(column.Brick);
             }
-        }
-    };
+            column = Column{ brick.To.Z, i }; });
+        supported_by_offsets.push_back(supported_by.size());
+    }
 
-    const auto print_xz = [&]()
+    // Removing a brick makes exactly those bricks fall that it dominates in the support graph rooted at the
+    // ground, i.e. that can only be reached from the ground through it. Since supports come before the bricks
+    // they support, the immediate dominator of a brick is the lowest common ancestor of its supports in the
+    // dominator tree built so far
+    const size_t num_nodes{ bricks.size() + 1 };
+    const size_t ground{ bricks.size() };
+    const size_t num_levels{ static_cast<size_t>(std::bit_width(num_nodes)) };
+    std::vector<size_t> ancestors(num_levels * num_nodes, ground);
+    std::vector<size_t> depths(num_nodes, 0);
+    const auto ancestor = [&](size_t level, size_t node) -> size_t&
+    {
+        return ancestors[level * num_nodes + node];
+    };
+    const auto lowest_common_ancestor = [&](size_t lhs, size_t rhs)
     {
-        std::string str;
-        for (int64_t zz = 0; zz <= world_max.Z; zz++)
+        if (depths[lhs] < depths[rhs])
+        {
+            std::swap(lhs, rhs);
+        }
+        for (size_t level = num_levels; level-- > 0;)
         {
-            const int64_t z = world_max.Z - zz;
-            for (int64_t x = 0; x <= world_max.X; x++)
+            if (depths[lhs] - depths[rhs] >= (size_t{ 1 } << level))
             {
-                char c{ ' ' };
-                for (int64_t y = 0; y <= world_max.Y; y++)
-                {
-                    const size_t i{ world[x][y][z] };
-                    if (i == c_Ground)
-                    {
-                        c = '~';
-                        break;
-                    }
-                    else if (i != c_Air)
-                    {
-                        size_t d{ 'A' + i };
-                        if (d > 'Z')
-                        {
-                            d = (d - 'A') % ('Z' - 'A') + 'A';
-                        }
-
-                        char dd{ char(d) };
-                        if (c == ' ')
-                        {
-                            c = dd;
-                        }
-                        else if (c != dd)
-                        {
-                            c = '?';
-                            break;
-                        }
-                    }
-                }
-                str += c;
+                lhs = ancestor(level, lhs);
             }
-            str += '\n';
         }
-        fmt::print("{}\n", str);
-    };
-    const auto print_yz = [&]()
-    {
-        std::string str;
-        for (int64_t zz = 0; zz <= world_max.Z; zz++)
+        if (lhs == rhs)
+        {
+            return lhs;
+        }
+        for (size_t level = num_levels; level-- > 0;)
         {
-            const int64_t z = world_max.Z - zz;
-            for (int64_t y = 0; y <= world_max.Y; y++)
+            if (ancestor(level, lhs) != ancestor(level, rhs))
             {
-                char c{ ' ' };
-                for (int64_t x = 0; x <= world_max.X; x++)
-                {
-                    const size_t i{ world[x][y][z] };
-                    if (i == c_Ground)
-                    {
-                        c = '~';
-                        break;
-                    }
-                    else if (i != c_Air)
-                    {
-                        size_t d{ 'A' + i };
-                        if (d > 'Z')
-                        {
-                            d = (d - 'A') % ('Z' - 'A') + 'A';
-                        }
-
-                        char dd{ char(d) };
-                        if (c == ' ')
-                        {
-                            c = dd;
-                        }
-                        else if (c != dd)
-                        {
-                            c = '?';
-                            break;
-                        }
-                    }
-                }
-                str += c;
+                lhs = ancestor(level, lhs);
+                rhs = ancestor(level, rhs);
             }
-            str += '\n';
         }
-        fmt::print("{}\n", str);
+        return ancestor(0, lhs);
     };
 
-    print_xz();
-    print_yz();
-    settle();
-    print_xz();
-    print_yz();
-
-    // Mark which bricks are supported by which other bricks
-    for (const auto& [i, brick] : std::views::enumerate(bricks))
+    for (size_t i = 0; i < bricks.size(); i++)
     {
-        const Vec3 from{ brick.From.X, brick.From.Y, std::min(brick.From.Z, brick.To.Z) };
-        const Vec3 to{ brick.To.X, brick.To.Y, std::max(brick.To.Z, brick.From.Z) };
-        const Vec3 dir{ (to - from).normalized() };
-        const Vec3 up{ 0, 0, 1 };
-
-        Vec3 pos{ brick.From };
-        while (pos != to + dir)
+        size_t dominator{ ground };
+        for (size_t j = supported_by_offsets[i]; j < supported_by_offsets[i + 1]; j++)
         {
-            [[maybe_unused]] const auto here{ world[pos.X][pos.Y][pos.Z] };
-            assert(here == static_cast<size_t>(i));
-
-            if (pos.Z < world_max.Z)
-            {
-                const Vec3 above{ pos + up };
-                const size_t i_above{ world[above.X][above.Y][above.Z] };
-                if (i_above != static_cast<size_t>(i) && i_above != c_Air)
-                {
-                    bricks[i].Supports.insert(i_above);
-                    bricks[i_above].SupportedBy.insert(i);
-                }
-            }
-            pos = pos + dir;
+            dominator = j == supported_by_offsets[i]
+                            ? supported_by[j]
+                            : lowest_common_ancestor(dominator, supported_by[j]);
         }
-    }
 
-    const auto compute_num_falling_bricks = [](this const auto& self, size_t i, auto& bricks) -> size_t
-    {
-        auto& brick{ bricks[i] };
-
-        size_t num_falling_bricks{};
-        for (const auto& j : brick.Supports)
+        depths[i] = depths[dominator] + 1;
+        ancestor(0, i) = dominator;
+        for (size_t level = 1; level < num_levels; level++)
         {
-            bricks[j].SupportedBy.erase(i);
-            if (bricks[j].SupportedBy.empty())
-            {
-                num_falling_bricks += 1 + self(j, bricks);
-            }
+            ancestor(level, i) = ancestor(level - 1, ancestor(level - 1, i));
         }
-        return num_falling_bricks;
-    };
+    }
 
-    size_t num_falling_bricks{};
-    for (size_t i = 0; i < bricks.size(); i++)
+    // Dominated bricks always come later, so sub-tree sizes can be summed up in reverse order
+    std::vector<size_t> num_dominated(num_nodes, 0);
+    for (size_t i = bricks.size(); i-- > 0;)
     {
-        auto bricks_cpy{ bricks };
-        num_falling_bricks += compute_num_falling_bricks(i, bricks_cpy);
+        num_dominated[ancestor(0, i)] += num_dominated[i] + 1;
     }
 
+    const size_t num_falling_bricks{ algo::accumulate(std::span{ num_dominated }.first(bricks.size()), size_t{ 0 }) };
     fmt::print("The result is: {}", num_falling_bricks);
     return num_falling_bricks != 79144;
 }
@@ -1,57 +1,44 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cctype>
-#include <compare>
-#include <queue>
+#include <limits>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "corridor_graph.h"
+#include "parallel.h"
 
-struct Vec2
+// Visited junctions are tracked as bits of a single word or of as many words as there are junctions
+void visit(uint64_t& visited, uint32_t junction)
 {
-    int64_t X;
-    int64_t Y;
-
-    auto operator<=>(const Vec2&) const = default;
-
-    Vec2 operator+(const Vec2& rhs) const
-    {
-        return Vec2{ X + rhs.X, Y + rhs.Y };
-    }
-    Vec2 operator-(const Vec2& rhs) const
-    {
-        return Vec2{ X - rhs.X, Y - rhs.Y };
-    }
-};
-
-struct Node;
-
-struct Edge
+    visited |= uint64_t{ 1 } << junction;
+}
+void unvisit(uint64_t& visited, uint32_t junction)
 {
-    size_t Length;
-    size_t To;
-};
-
-struct Node
+    visited &= ~(uint64_t{ 1 } << junction);
+}
+bool is_visited(uint64_t visited, uint32_t junction)
 {
-    Vec2 Pos;
-    size_t Id;
-    std::vector<Edge> Edges;
-};
+    return (visited & (uint64_t{ 1 } << junction)) != 0;
+}
 
-struct Hike
+void visit(std::vector<uint64_t>& visited, uint32_t junction)
 {
-    size_t Length;
-    Node* AtNode;
-    std::unordered_set<Node*> Visited;
-
-    auto operator<=>(const Hike& rhs) const
-    {
-        return Length <=> rhs.Length;
-    }
-};
+    visited[junction / 64] |= uint64_t{ 1 } << (junction % 64);
+}
+void unvisit(std::vector<uint64_t>& visited, uint32_t junction)
+{
+    visited[junction / 64] &= ~(uint64_t{ 1 } << (junction % 64));
+}
+bool is_visited(const std::vector<uint64_t>& visited, uint32_t junction)
+{
+    return (visited[junction / 64] & (uint64_t{ 1 } << (junction % 64))) != 0;
+}
 
 int main(int argc, char** argv)
 {
@@ -61,181 +48,213 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    static constexpr auto to_vector{ std::ranges::to<std::vector>() };
-    static constexpr auto lines{ std::views::split('\n') };
-    static constexpr auto to_string_views{ std::views::transform(
-        [](auto str)
-        { return std::string_view(str.data(), str.size()); }) };
-
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
-    const std::vector landscape{ file_data | lines | to_string_views | to_vector };
+    // The start is the only open tile in the first row and the exit the only one in the last row
+    const size_t stride{ file_data.find('\n') + 1 };
+    const std::array endpoints{ file_data.find('.'), file_data.find_last_of('.') };
+    const CorridorGraph graph{ algo::compress_corridors(file_data, stride, endpoints, SlopeBehavior::Ignore) };
 
-    const Vec2 landscape_min{ 0, 0 };
-    const Vec2 landscape_max{ static_cast<int64_t>(landscape.front().size()), static_cast<int64_t>(landscape.size()) };
-    const auto out_of_bounds = [&](const auto& coord)
+    static constexpr size_t c_MaxEdges{ 4 };
+    struct Junction
+    {
+        uint32_t NumEdges;
+        std::array<uint32_t, c_MaxEdges> To;
+        std::array<uint32_t, c_MaxEdges> Length;
+        uint32_t LongestEdge;
+        uint32_t TwoLongestEdges;
+    };
+    std::vector<Junction> junctions(graph.num_nodes(), Junction{});
+    for (uint32_t node = 0; node < graph.num_nodes(); node++)
     {
-        const auto& [x, y] = coord;
-        if (x < landscape_min.X ||
-            y < landscape_min.Y ||
-            x >= landscape_max.X ||
-            y >= landscape_max.Y)
+        Junction& junction{ junctions[node] };
+
+        // Trying long edges first finds long hikes early, which makes the bound below prune more
+        std::array<std::pair<uint32_t, uint32_t>, c_MaxEdges> edges{};
+        for (const auto& [length, to] : std::views::zip(graph.lengths(node), graph.targets(node)))
+        {
+            assert(junction.NumEdges < c_MaxEdges);
+            edges[junction.NumEdges++] = { length, to };
+        }
+        std::ranges::sort(edges, std::greater{});
+        for (size_t i = 0; i < c_MaxEdges; i++)
         {
-            return true;
+            junction.Length[i] = edges[i].first;
+            junction.To[i] = edges[i].second;
         }
+        junction.LongestEdge = junction.Length[0];
+        junction.TwoLongestEdges = junction.Length[0] + junction.Length[1];
+    }
 
-        const auto tile{ landscape[y][x] };
-        return tile == '#';
-    };
+    static constexpr uint32_t c_Start{ 0 };
+    static constexpr uint32_t c_Exit{ 1 };
+    // Leaving the junction before the exit in any other direction can never reach the exit anymore
+    const uint32_t last_junction{ junctions[c_Exit].NumEdges == 1 ? junctions[c_Exit].To[0] : c_Exit };
 
-    std::vector<Node> nodes{
-        Node{ { 1, 0 }, 0 },
-        Node{ { landscape_max.X - 2, landscape_max.Y - 1 }, 1 },
-    };
+    // Every junction the rest of a hike passes through uses two of its edges, and every edge is shared by two
+    // junctions. So twice the remaining length is bounded by the longest edge of the current junction plus
+    // the two longest edges of every junction not visited yet
+    size_t remaining_bound{ 0 };
+    for (const Junction& junction : junctions)
+    {
+        remaining_bound += junction.TwoLongestEdges;
+    }
 
+    // Shared by all threads so that every one of them prunes against the longest hike found by any
+    std::atomic<size_t> maximum_path{ 0 };
+    const auto update_maximum_path = [&](size_t length)
     {
-        std::vector visited(landscape_max.X, std::vector(landscape_max.Y, false));
-        visited[0][1] = true;
+        size_t current{ maximum_path.load(std::memory_order_relaxed) };
+        while (length > current && !maximum_path.compare_exchange_weak(current, length, std::memory_order_relaxed))
+        {
+        }
+    };
 
-        std::vector<std::tuple<size_t, Vec2, Vec2>> nexts{
-            { nodes[0].Id, nodes[0].Pos, nodes[0].Pos + Vec2{ 0, 1 } },
-            { nodes[1].Id, nodes[1].Pos, nodes[1].Pos - Vec2{ 0, 1 } },
-        };
-        while (!nexts.empty())
+    // Searches with the visited junctions in a VisitedT, a single word if there are at most 64 junctions
+    // and as many words as needed otherwise
+    const auto search_all = [&]<class VisitedT>(VisitedT no_junctions_visited)
+    {
+        // A partial hike that still has to be searched exhaustively, from edge FirstEdge of its junction on
+        struct SearchTask
         {
-            const auto [i, from, start] = nexts.front();
-            nexts.erase(nexts.begin());
+            VisitedT Visited;
+            uint32_t AtJunction;
+            uint32_t FirstEdge;
+            size_t Length;
+            size_t RemainingBound;
+        };
 
+        // Depth-first search from the task, instead of going deeper than split_depth junctions the partial
+        // hike is handed to on_split. Whenever wants_split says so, the unexplored edges closest to the
+        // start of the task are handed to on_split as well
+        const auto search = [&](SearchTask task, size_t split_depth, auto&& on_split, auto&& wants_split)
+        {
+            struct Hike
+            {
+                uint32_t AtJunction;
+                uint32_t NextEdge;
+                uint32_t EndEdge;
+                size_t Length;
+            };
+            std::vector<Hike> hikes{ Hike{ task.AtJunction, task.FirstEdge, junctions[task.AtJunction].NumEdges, task.Length } };
+            VisitedT& visited{ task.Visited };
+            size_t& remaining_bound{ task.RemainingBound };
+
+            const auto split_shallowest = [&]()
             {
-                const auto& [x, y] = start;
-                if (visited[y][x])
+                for (size_t depth = 0; depth + 1 < hikes.size(); depth++)
                 {
-                    continue;
+                    Hike& hike{ hikes[depth] };
+                    if (hike.NextEdge == hike.EndEdge)
+                    {
+                        continue;
+                    }
+
+                    // Rewind everything visited below this hike
+                    SearchTask split_task{ visited, hike.AtJunction, hike.NextEdge, hike.Length, remaining_bound };
+                    for (const Hike& deeper : hikes | std::views::drop(depth + 1))
+                    {
+                        unvisit(split_task.Visited, deeper.AtJunction);
+                        split_task.RemainingBound += junctions[deeper.AtJunction].TwoLongestEdges;
+                    }
+                    hike.EndEdge = hike.NextEdge;
+                    on_split(std::move(split_task));
+                    return;
                 }
-                visited[y][x] = true;
-            }
+            };
 
-            size_t length{ 1 };
-            Vec2 prev{ from };
-            Vec2 to{ start };
-            while (true)
+            while (!hikes.empty())
             {
-                const std::array dirs{
-                    to + Vec2{ +1, 0 },
-                    to + Vec2{ -1, 0 },
-                    to + Vec2{ 0, +1 },
-                    to + Vec2{ 0, -1 },
-                };
-
-                if (algo::count(dirs, out_of_bounds, true) < 2)
+                Hike& hike{ hikes.back() };
+                const Junction& junction{ junctions[hike.AtJunction] };
+                if (hike.NextEdge == hike.EndEdge)
                 {
-                    break;
+                    unvisit(visited, hike.AtJunction);
+                    remaining_bound += junction.TwoLongestEdges;
+                    hikes.pop_back();
+                    continue;
                 }
 
-                for (auto& next : dirs)
+                const uint32_t edge{ hike.NextEdge++ };
+                const uint32_t to{ junction.To[edge] };
+                if (is_visited(visited, to) || (hike.AtJunction == last_junction && to != c_Exit))
                 {
-                    if (!out_of_bounds(next) && next != prev)
-                    {
-                        prev = to;
-                        to = next;
-                        length++;
-                        break;
-                    }
+                    continue;
                 }
 
+                const size_t length{ hike.Length + junction.Length[edge] };
+                if (to == c_Exit)
                 {
-                    const auto& [x, y] = to;
-                    if (visited[y][x])
-                    {
-                        break;
-                    }
-                    visited[y][x] = true;
+                    update_maximum_path(length);
+                    continue;
                 }
-            }
 
-            if (Node * node{ algo::find(nodes, &Node::Pos, to) })
-            {
-                nodes[i].Edges.push_back({ length, static_cast<size_t>(node - &nodes.front()) });
-                node->Edges.push_back({ length, i });
-            }
-            else
-            {
-                const auto try_push = [&](Vec2 p)
+                const size_t next_remaining_bound{ remaining_bound - junctions[to].TwoLongestEdges };
+                if (2 * length + junctions[to].LongestEdge + next_remaining_bound <= 2 * maximum_path.load(std::memory_order_relaxed))
                 {
-                    const auto& [x, y] = p;
-                    if (out_of_bounds(p))
-                    {
-                        return;
-                    }
-                    else if (visited[y][x] && !algo::contains(nodes, &Node::Pos, p))
-                    {
-                        return;
-                    }
-                    nexts.push_back({ nodes.size(), to, p });
-                };
-                try_push(to + Vec2{ +1, 0 });
-                try_push(to + Vec2{ -1, 0 });
-                try_push(to + Vec2{ 0, +1 });
-                try_push(to + Vec2{ 0, -1 });
-
-                nodes[i].Edges.push_back({ length, nodes.size() });
-                nodes.push_back(Node{ to, nodes.size(), { { length, i } } });
-            }
-        }
-    }
-
-    std::optional<size_t> maximum_path{ std::nullopt };
-    std::vector<Hike> hikes{
-        Hike{ 0, &nodes[0] }
-    };
+                    continue;
+                }
 
-    while (!hikes.empty())
-    {
-        const Hike hike{ hikes.back() };
-        hikes.pop_back();
+                if (hikes.size() == split_depth)
+                {
+                    SearchTask split_task{ visited, to, 0, length, next_remaining_bound };
+                    visit(split_task.Visited, to);
+                    on_split(std::move(split_task));
+                    continue;
+                }
 
-        for (const Edge& edge : hike.AtNode->Edges)
-        {
-            const auto [len, to] = edge;
-            if (hike.Visited.contains(&nodes[to]))
-            {
-                continue;
-            }
+                visit(visited, to);
+                remaining_bound = next_remaining_bound;
+                hikes.push_back(Hike{ to, 0, junctions[to].NumEdges, length });
 
-            {
-                const auto [tx, ty] = nodes[to].Pos;
-                const bool on_target{
-                    tx == landscape_max.X - 2 &&
-                    ty == landscape_max.Y - 1
-                };
-                if (on_target)
+                if (wants_split())
                 {
-                    const size_t total_length{ hike.Length + edge.Length };
-                    if (!maximum_path.has_value() || total_length > maximum_path.value())
-                    {
-                        fmt::print("Found new max path: {}\n", total_length);
-                        maximum_path = total_length;
-                    }
-                    continue;
+                    split_shallowest();
                 }
             }
+        };
 
-            Hike next_hike{ hike };
-            next_hike.Length += edge.Length;
-            next_hike.AtNode = &nodes[to];
-            next_hike.Visited.insert(hike.AtNode);
-            hikes.push_back(next_hike);
+        // Enumerate all hikes up to a fixed depth and search the rest of each one in parallel, threads that
+        // run out of hikes take over the shallowest unexplored part of a running search
+        static constexpr size_t c_SplitDepth{ 8 };
+        static constexpr auto never_split = []()
+        {
+            return false;
+        };
+        std::vector<SearchTask> tasks;
+        {
+            SearchTask first_task{ no_junctions_visited, c_Start, 0, 0, remaining_bound - junctions[c_Start].TwoLongestEdges };
+            visit(first_task.Visited, c_Start);
+            search(
+                std::move(first_task), c_SplitDepth, [&](SearchTask task)
+                { tasks.push_back(std::move(task)); },
+                never_split);
         }
+        algo::parallel_for_each(std::move(tasks), [&](SearchTask task, const TaskSpawner<SearchTask>& spawner)
+                                { search(
+                                      std::move(task), std::numeric_limits<size_t>::max(), [&](SearchTask split_task)
+                                      { spawner.spawn(std::move(split_task)); },
+                                      [&]()
+                                      { return spawner.wants_tasks(); }); });
+    };
+
+    if (junctions.size() <= 64)
+    {
+        search_all(uint64_t{ 0 });
+    }
+    else
+    {
+        search_all(std::vector<uint64_t>((junctions.size() + 63) / 64, 0));
     }
 
-    if (!maximum_path.has_value())
+    const size_t maximum_path_length{ maximum_path.load() };
+    if (maximum_path_length == 0)
     {
         fmt::print("No path found...");
         return 1;
     }
 
-    const size_t maximum_path_length{ maximum_path.value() };
     fmt::print("The result is: {}", maximum_path_length);
     return maximum_path_length != 6450;
 }
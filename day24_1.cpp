@@ -1,63 +1,13 @@
-#include <cassert>
+#include <algorithm>
 #include <cctype>
 #include <compare>
-#include <queue>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
-
-struct DVec2
-{
-    double X;
-    double Y;
-
-    auto operator<=>(const DVec2&) const = default;
-
-    DVec2 operator+(const int64_t& rhs) const
-    {
-        return DVec2{ X + rhs, Y + rhs };
-    }
-    DVec2 operator*(const int64_t& rhs) const
-    {
-        return DVec2{ X * rhs, Y * rhs };
-    }
-    DVec2 operator+(const DVec2& rhs) const
-    {
-        return DVec2{ X + rhs.X, Y + rhs.Y };
-    }
-    DVec2 operator-(const DVec2& rhs) const
-    {
-        return DVec2{ X - rhs.X, Y - rhs.Y };
-    }
-};
-
-struct Vec2
-{
-    int64_t X;
-    int64_t Y;
-
-    auto operator<=>(const Vec2&) const = default;
-
-    Vec2 operator+(const int64_t& rhs) const
-    {
-        return Vec2{ X + rhs, Y + rhs };
-    }
-    Vec2 operator*(const int64_t& rhs) const
-    {
-        return Vec2{ X * rhs, Y * rhs };
-    }
-    Vec2 operator+(const Vec2& rhs) const
-    {
-        return Vec2{ X + rhs.X, Y + rhs.Y };
-    }
-    Vec2 operator-(const Vec2& rhs) const
-    {
-        return Vec2{ X - rhs.X, Y - rhs.Y };
-    }
-};
+#include "parallel.h"
 
 struct Vec3
 {
@@ -91,11 +41,6 @@ struct Hail
     Vec3 Vel;
 };
 
-struct Intersection
-{
-    Vec2 At;
-};
-
 int main(int argc, char** argv)
 {
     if (argc != 2)
@@ -128,93 +73,99 @@ int main(int argc, char** argv)
             return Hail{ vecs[0], vecs[1] };
         }) };
 
-    static constexpr auto get_intersection = [](const Hail& lhs, const Hail& rhs) -> std::optional<Intersection>
-    {
-        const DVec2 lhs_vel{ static_cast<double>(lhs.Vel.X), static_cast<double>(lhs.Vel.Y) };
-        const DVec2 rhs_vel{ static_cast<double>(rhs.Vel.X), static_cast<double>(rhs.Vel.Y) };
+    const std::string_view input_file{ argv[1] };
+    const std::string file_data{ algo::read_whole_file(input_file) };
 
-        const double lhs_m{ lhs_vel.Y / lhs_vel.X };
-        const double rhs_m{ rhs_vel.Y / rhs_vel.X };
-        if (lhs_m == rhs_m)
-        {
-            // Parallel
-            return std::nullopt;
-        }
+    const std::vector hail{ file_data | lines | to_string_views | to_hails | to_vector };
 
-        const DVec2 lhs_pos{ static_cast<double>(lhs.Pos.X), static_cast<double>(lhs.Pos.Y) };
-        const DVec2 rhs_pos{ static_cast<double>(rhs.Pos.X), static_cast<double>(rhs.Pos.Y) };
+    // Positions are relative to the test area, which keeps them small enough for doubles to stay precise
+    static constexpr int64_t c_TestMin{ 200000000000000 };
+    static constexpr int64_t c_TestMax{ 400000000000000 };
+    static constexpr double c_TestSize{ static_cast<double>(c_TestMax - c_TestMin) };
 
-        double x_i{};
-        double y_i{};
-        double lhs_t{};
-        double rhs_t{};
-        if (lhs_m == std::numeric_limits<double>::infinity())
-        {
-            // lhs is vertical
-            x_i = lhs_pos.X;
-            y_i = rhs_m * (x_i - rhs_pos.X) + rhs_pos.Y;
-            lhs_t = (y_i - lhs_pos.Y) / lhs_vel.Y;
-            rhs_t = (y_i - rhs_pos.Y) / rhs_vel.Y;
-        }
-        else if (lhs_m == std::numeric_limits<double>::infinity())
-        {
-            // rhs is vertical
-            x_i = rhs_pos.X;
-            y_i = lhs_m * (x_i - lhs_pos.X) + lhs_pos.Y;
-            lhs_t = (x_i - lhs_pos.X) / lhs_vel.X;
-            rhs_t = (x_i - rhs_pos.X) / rhs_vel.X;
-        }
-        else
-        {
-            // Solve: y = y0 + m * (x - x0) for x
-            x_i = (lhs_pos.Y - rhs_pos.Y - lhs_pos.X * lhs_m + rhs_pos.X * rhs_m) / (rhs_m - lhs_m);
-            y_i = lhs_pos.Y + lhs_m * (x_i - lhs_pos.X);
-            lhs_t = (x_i - lhs_pos.X) / lhs_vel.X;
-            rhs_t = (x_i - rhs_pos.X) / rhs_vel.X;
-        }
+    // Structure of arrays, so that the loop over the second hail of each pair reads consecutive values
+    struct HailArrays
+    {
+        std::vector<double> PosX;
+        std::vector<double> PosY;
+        std::vector<double> VelX;
+        std::vector<double> VelY;
+    };
+    HailArrays arrays{};
+    for (const auto& [pos, vel] : hail)
+    {
+        arrays.PosX.push_back(static_cast<double>(pos.X - c_TestMin));
+        arrays.PosY.push_back(static_cast<double>(pos.Y - c_TestMin));
+        arrays.VelX.push_back(static_cast<double>(vel.X));
+        arrays.VelY.push_back(static_cast<double>(vel.Y));
+    }
 
-        if (lhs_t < 0 || rhs_t < 0)
+    // Counts the intersections of one hail with all hail in [begin, end). Solving
+    //      pos_i + vel_i * t = pos_j + vel_j * s
+    // with Cramer's rule gives both times as a fraction over the same determinant, all checks are
+    // combined without branches so the loop can be vectorized
+    const auto count_intersections = [&](size_t i, size_t begin, size_t end)
+    {
+        const double pos_x{ arrays.PosX[i] };
+        const double pos_y{ arrays.PosY[i] };
+        const double vel_x{ arrays.VelX[i] };
+        const double vel_y{ arrays.VelY[i] };
+        const double* other_pos_x{ arrays.PosX.data() };
+        const double* other_pos_y{ arrays.PosY.data() };
+        const double* other_vel_x{ arrays.VelX.data() };
+        const double* other_vel_y{ arrays.VelY.data() };
+
+        // Counted in a double, selecting between two doubles keeps every lane the same width as the
+        // compared values, which vectorizes even on plain SSE2
+        double num_intersections{ 0.0 };
+        for (size_t j = begin; j < end; j++)
         {
-            return std::nullopt;
+            const double det{ vel_x * other_vel_y[j] - vel_y * other_vel_x[j] };
+            const double dx{ other_pos_x[j] - pos_x };
+            const double dy{ other_pos_y[j] - pos_y };
+            const double t_times_det{ dx * other_vel_y[j] - dy * other_vel_x[j] };
+            const double s_times_det{ dx * vel_y - dy * vel_x };
+            const double t{ t_times_det / det };
+            const double x{ pos_x + vel_x * t };
+            const double y{ pos_y + vel_y * t };
+
+            // Bitwise and on purpose, short-circuiting would introduce branches. Every comparison is
+            // turned into an int first, so no int is ever combined with a bool
+            const int intersects{
+                int{ det != 0.0 } &
+                int{ t_times_det * det >= 0.0 } &
+                int{ s_times_det * det >= 0.0 } &
+                int{ x >= 0.0 } & int{ x <= c_TestSize } &
+                int{ y >= 0.0 } & int{ y <= c_TestSize }
+            };
+            num_intersections += intersects != 0 ? 1.0 : 0.0;
         }
-
-        // Note: Has to fit into an int64
-        return {
-            {
-                static_cast<int64_t>(x_i),
-                static_cast<int64_t>(y_i),
-            },
-        };
+        return static_cast<size_t>(num_intersections);
     };
 
-    const std::string_view input_file{ argv[1] };
-    const std::string file_data{ algo::read_whole_file(input_file) };
-
-    const std::vector hail{ file_data | lines | to_string_views | to_hails | to_vector };
-
-    const Vec2 test_min{ 200000000000000, 200000000000000 };
-    const Vec2 test_max{ 400000000000000, 400000000000000 };
-
-    size_t num_intersections{ 0 };
-    for (size_t i = 0; i < hail.size(); i++)
-    {
-        const Hail& lhs{ hail[i] };
-        for (size_t j = i + 1; j < hail.size(); j++)
+    // Blocks of rows go to all threads, within a block the pairs are tiled so the tile of second hail
+    // stays in cache for all rows of the block
+    static constexpr size_t c_RowsPerBlock{ 64 };
+    static constexpr size_t c_ColumnsPerTile{ 2048 };
+    const size_t num_blocks{ (hail.size() + c_RowsPerBlock - 1) / c_RowsPerBlock };
+    std::vector<size_t> block_intersections(num_blocks, 0);
+    algo::parallel_for_each(
+        std::views::iota(size_t{ 0 }, num_blocks) | to_vector,
+        [&](size_t block)
         {
-            const Hail& rhs{ hail[j] };
-            if (const std::optional intersection{ get_intersection(lhs, rhs) })
+            const size_t rows_begin{ block * c_RowsPerBlock };
+            const size_t rows_end{ std::min(rows_begin + c_RowsPerBlock, hail.size()) };
+            for (size_t tile_begin = rows_begin + 1; tile_begin < hail.size(); tile_begin += c_ColumnsPerTile)
             {
-                if (intersection->At.X >= test_min.X &&
-                    intersection->At.Y >= test_min.Y &&
-                    intersection->At.X <= test_max.X &&
-                    intersection->At.Y <= test_max.Y)
+                const size_t tile_end{ std::min(tile_begin + c_ColumnsPerTile, hail.size()) };
+                for (size_t i = rows_begin; i < rows_end; i++)
                 {
-                    num_intersections++;
+                    block_intersections[block] += count_intersections(i, std::max(tile_begin, i + 1), tile_end);
                 }
             }
-        }
-    }
+        });
 
+    const size_t num_intersections{ algo::accumulate(block_intersections, size_t{ 0 }) };
     fmt::print("The result is: {}", num_intersections);
     return num_intersections != 18098;
 }
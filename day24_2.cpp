@@ -1,39 +1,14 @@
-﻿#include <cassert>
+﻿#include <array>
 #include <cctype>
 #include <compare>
-#include <queue>
+#include <optional>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
-
-template<class T>
-struct TVec2
-{
-    T X;
-    T Y;
-
-    auto operator<=>(const TVec2&) const = default;
-
-    TVec2 operator+(const T& rhs) const
-    {
-        return TVec2{ X + rhs, Y + rhs };
-    }
-    TVec2 operator*(const T& rhs) const
-    {
-        return TVec2{ X * rhs, Y * rhs };
-    }
-    TVec2 operator+(const TVec2& rhs) const
-    {
-        return TVec2{ X + rhs.X, Y + rhs.Y };
-    }
-    TVec2 operator-(const TVec2& rhs) const
-    {
-        return TVec2{ X - rhs.X, Y - rhs.Y };
-    }
-};
+#include "int128.h"
 
 template<class T>
 struct TVec3
@@ -62,9 +37,6 @@ struct TVec3
     }
 };
 
-using DVec2 = TVec2<double>;
-using DVec3 = TVec3<double>;
-using Vec2 = TVec2<int64_t>;
 using Vec3 = TVec3<int64_t>;
 
 struct Hail
@@ -73,11 +45,6 @@ struct Hail
     Vec3 Vel;
 };
 
-struct Intersection
-{
-    Vec2 At;
-};
-
 int main(int argc, char** argv)
 {
     if (argc != 2)
@@ -110,220 +77,147 @@ int main(int argc, char** argv)
             return Hail{ vecs[0], vecs[1] };
         }) };
 
-    static constexpr auto project_velocity = [](const Vec3& v, bool project_xz)
+    const std::string_view input_file{ argv[1] };
+    const std::string file_data{ algo::read_whole_file(input_file) };
+
+    const std::vector hail{ file_data | lines | to_string_views | to_hails | to_vector };
+
+    // Everything is exact, positions times velocities need more than 64 bits
+    using WideVec3 = std::array<int128_t, 3>;
+    static constexpr auto widen = [](const Vec3& v)
     {
-        return project_xz
-                   ? DVec2{ static_cast<double>(v.X), static_cast<double>(v.Z) }
-                   : DVec2{ static_cast<double>(v.X), static_cast<double>(v.Y) };
+        return WideVec3{ int128_t{ v.X }, int128_t{ v.Y }, int128_t{ v.Z } };
     };
-    static constexpr auto get_time_at_intersection = [](const Hail& hail, const Vec3& dv, const Intersection& intersection)
+    static constexpr auto sub = [](const WideVec3& lhs, const WideVec3& rhs)
     {
-        // Transform hail into stones reference-frame
-        const DVec2 v{ project_velocity(hail.Vel - dv, false) };
-
-        if (hail.Vel.Y == dv.Y)
-        {
-            return static_cast<double>(intersection.At.X - hail.Pos.X) / v.X;
-        }
-        else
-        {
-            return static_cast<double>(intersection.At.Y - hail.Pos.Y) / v.Y;
-        }
+        return WideVec3{ lhs[0] - rhs[0], lhs[1] - rhs[1], lhs[2] - rhs[2] };
+    };
+    static constexpr auto dot = [](const WideVec3& lhs, const WideVec3& rhs)
+    {
+        return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
     };
-    static constexpr auto get_intersection = [](const Hail& lhs, const Hail& rhs, const Vec3& dv, bool project_xz) -> std::optional<Intersection>
+    static constexpr auto cross = [](const WideVec3& lhs, const WideVec3& rhs)
     {
-        // Transform hail into stones reference-frame
-        const DVec2 lhs_vel{ project_velocity(lhs.Vel - dv, project_xz) };
-        const DVec2 rhs_vel{ project_velocity(rhs.Vel - dv, project_xz) };
+        return WideVec3{
+            lhs[1] * rhs[2] - lhs[2] * rhs[1],
+            lhs[2] * rhs[0] - lhs[0] * rhs[2],
+            lhs[0] * rhs[1] - lhs[1] * rhs[0],
+        };
+    };
 
-        const double lhs_m{ lhs_vel.Y / lhs_vel.X };
-        const double rhs_m{ rhs_vel.Y / rhs_vel.X };
-        if (lhs_m != lhs_m || rhs_m != rhs_m)
+    // In the reference frame of the origin hail it sits still at the origin, so the stone has to pass
+    // through the origin as well. That puts the stone into the plane through the origin and the path of
+    // every other hail, and each of them hits the stone where its path crosses the plane of another one
+    static constexpr auto solve_stone = [](const Hail& origin, const Hail& first, const Hail& second) -> std::optional<Hail>
+    {
+        const WideVec3 first_pos{ sub(widen(first.Pos), widen(origin.Pos)) };
+        const WideVec3 first_vel{ sub(widen(first.Vel), widen(origin.Vel)) };
+        const WideVec3 second_pos{ sub(widen(second.Pos), widen(origin.Pos)) };
+        const WideVec3 second_vel{ sub(widen(second.Vel), widen(origin.Vel)) };
+        const WideVec3 first_normal{ cross(first_pos, first_vel) };
+        const WideVec3 second_normal{ cross(second_pos, second_vel) };
+
+        const int128_t first_speed_to_plane{ dot(first_vel, second_normal) };
+        const int128_t second_speed_to_plane{ dot(second_vel, first_normal) };
+        if (first_speed_to_plane == 0 || second_speed_to_plane == 0)
         {
-            // NaN
-            // o.0
             return std::nullopt;
         }
-        if (lhs_m == rhs_m)
+
+        const int128_t first_distance_to_plane{ -dot(first_pos, second_normal) };
+        const int128_t second_distance_to_plane{ -dot(second_pos, first_normal) };
+        if (first_distance_to_plane % first_speed_to_plane != 0 || second_distance_to_plane % second_speed_to_plane != 0)
         {
-            // Parallel
             return std::nullopt;
         }
 
-        const DVec2 lhs_pos{ project_velocity(lhs.Pos, project_xz) };
-        const DVec2 rhs_pos{ project_velocity(rhs.Pos, project_xz) };
-
-        double x_i{};
-        double y_i{};
-        if (std::abs(lhs_m) == std::numeric_limits<double>::infinity())
-        {
-            // lhs is vertical
-            x_i = lhs_pos.X;
-            y_i = rhs_m * (x_i - rhs_pos.X) + rhs_pos.Y;
-        }
-        else if (std::abs(rhs_m) == std::numeric_limits<double>::infinity())
-        {
-            // rhs is vertical
-            x_i = rhs_pos.X;
-            y_i = lhs_m * (x_i - lhs_pos.X) + lhs_pos.Y;
-        }
-        else
+        const int128_t first_t{ first_distance_to_plane / first_speed_to_plane };
+        const int128_t second_t{ second_distance_to_plane / second_speed_to_plane };
+        if (first_t < 0 || second_t < 0 || first_t == second_t)
         {
-            // Solve for x:
-            //      y_1 = y_10 + m_1 * (x - x_10)
-            //      y_2 = y_20 + m_2 * (x - x_20)
-            //      y_1 = y_2
-            x_i = (lhs_pos.Y - rhs_pos.Y - lhs_pos.X * lhs_m + rhs_pos.X * rhs_m) / (rhs_m - lhs_m);
-            y_i = lhs_pos.Y + lhs_m * (x_i - lhs_pos.X);
-
-            // Solve for x:
-            //      x_1 = x_10 + (y - y_10) / m_1
-            //      x_2 = x_20 + (y - y_20) / m_2
-            //      x_1 = x_2
-            // y_i = (lhs_pos.X - rhs_pos.X + lhs_m * rhs_pos.Y - rhs_m * lhs_pos.Y) / (lhs_m - rhs_m);
-            // x_i = lhs_pos.X + (y_i - lhs_pos.Y) / lhs_m;
+            return std::nullopt;
         }
 
-        // Note: Has to fit into an int64, but it maybe still wrong :(
-        Intersection intersection{
-            {
-                static_cast<int64_t>(std::round(x_i)),
-                static_cast<int64_t>(std::round(y_i)),
-            },
-        };
-
-        const double lhs_t{ get_time_at_intersection(lhs, dv, intersection) };
-        const double rhs_t{ get_time_at_intersection(rhs, dv, intersection) };
-
-        if (lhs_t < 0 || rhs_t < 0)
+        // Back in the original frame the stone moves from the first hit to the second one
+        WideVec3 stone_pos{};
+        WideVec3 stone_vel{};
+        for (size_t i = 0; i < 3; i++)
         {
-            return std::nullopt;
+            const int128_t first_hit{ widen(first.Pos)[i] + widen(first.Vel)[i] * first_t };
+            const int128_t second_hit{ widen(second.Pos)[i] + widen(second.Vel)[i] * second_t };
+            if ((second_hit - first_hit) % (second_t - first_t) != 0)
+            {
+                return std::nullopt;
+            }
+            stone_vel[i] = (second_hit - first_hit) / (second_t - first_t);
+            stone_pos[i] = first_hit - stone_vel[i] * first_t;
         }
 
-        // Note: Recalc from t, because the other might be wrong
-        intersection.At.X = lhs.Pos.X + (lhs.Vel.X - dv.X) * static_cast<int64_t>(std::round(lhs_t));
-        intersection.At.Y = lhs.Pos.Y + (lhs.Vel.Y - dv.Y) * static_cast<int64_t>(std::round(lhs_t));
-
-        return intersection;
-    };
-    static constexpr auto get_stone_z_vel_from_intersection = [](const Hail& lhs, const Hail& rhs, const Vec3& dv, const Intersection& intersection)
-    {
-        const double lhs_vz{ static_cast<double>(lhs.Vel.Z) };
-        const double rhs_vz{ static_cast<double>(rhs.Vel.Z) };
-        const double lhs_z{ static_cast<double>(lhs.Pos.Z) };
-        const double rhs_z{ static_cast<double>(rhs.Pos.Z) };
-        const double lhs_t{ get_time_at_intersection(lhs, dv, intersection) };
-        const double rhs_t{ get_time_at_intersection(rhs, dv, intersection) };
-        return static_cast<int64_t>((lhs_z - rhs_z + lhs_t * lhs_vz - rhs_t * rhs_vz) / (lhs_t - rhs_t));
+        return Hail{
+            Vec3{ static_cast<int64_t>(stone_pos[0]), static_cast<int64_t>(stone_pos[1]), static_cast<int64_t>(stone_pos[2]) },
+            Vec3{ static_cast<int64_t>(stone_vel[0]), static_cast<int64_t>(stone_vel[1]), static_cast<int64_t>(stone_vel[2]) },
+        };
     };
 
-    const std::string_view input_file{ argv[1] };
-    const std::string file_data{ algo::read_whole_file(input_file) };
-
-    const std::vector hail{ file_data | lines | to_string_views | to_hails | to_vector };
-
-    // Loop until the end of time (hopefully not tho)
-    for (const int64_t I : std::views::iota(int64_t{ 0 }))
+    // The stone hits a hail if all axes agree on a single point in time, unless they move in parallel
+    static constexpr auto hits = [](const Hail& stone, const Hail& hail)
     {
-        // Find an xy-velocity for which all hail hits the stone
-        //  Do this by transforming all the hail into the reference frame of the stone and finding
-        //  a velocity for which all hail points intersect at the same point in that reference frame.
-        //  That point will then be the origin of the stone, the velocity doesn't really matter for
-        //  the solution but we have that too at that point.
-        for (const int64_t X : std::views::iota(int64_t{ 0 }, I))
+        std::optional<int128_t> hit_t{ std::nullopt };
+        for (size_t i = 0; i < 3; i++)
         {
-            const int64_t Y{ X - I }; // No need to loop all of Y, there's too many redundant values
-            for (const Vec3& stone_vel : std::array{
-                     Vec3{ +X, +Y, 0 },
-                     Vec3{ -X, +Y, 0 },
-                     Vec3{ +X, -Y, 0 },
-                     Vec3{ -X, -Y, 0 },
-                 })
+            const int128_t distance{ widen(hail.Pos)[i] - widen(stone.Pos)[i] };
+            const int128_t closing_speed{ widen(stone.Vel)[i] - widen(hail.Vel)[i] };
+            if (closing_speed == 0)
             {
-                // Check if first two hails interesect
-                if (const std::optional first_intersection_xy{ get_intersection(hail[0], hail[1], stone_vel, false) })
+                if (distance != 0)
                 {
-                    // Then verify that all of the hail intersect at the same position
-                    const bool solves_xy{
-                        algo::all_of(hail | std::views::drop(2),
-                                     [&](const Hail& rhs)
-                                     {
-                                         const std::optional this_intersection_xy{ get_intersection(hail[0], rhs, stone_vel, false) };
-                                         if (!this_intersection_xy.has_value() || first_intersection_xy->At != this_intersection_xy->At)
-                                         {
-                                             return false;
-                                         }
-                                         return true;
-                                     })
-                    };
-                    if (!solves_xy)
-                    {
-                        continue;
-                    }
-
-                    {
-                        const Vec2 pos{
-                            first_intersection_xy->At.X,
-                            first_intersection_xy->At.Y,
-                        };
-                        fmt::print("Potential solution: {}, {} @ {}, {}\n",
-                                   pos.X,
-                                   pos.Y,
-                                   stone_vel.X,
-                                   stone_vel.Y);
-                    }
-
-                    // Compote what velocity the stone would've had for the two hail to intersect
-                    //  at this position.
-                    const int64_t Z{ get_stone_z_vel_from_intersection(
-                        hail[0], hail[1], stone_vel, first_intersection_xy.value()) };
-                    const Vec3& stone_vel_with_z{ stone_vel.X, stone_vel.Y, Z };
+                    return false;
+                }
+                continue;
+            }
 
-                    // Verify that the same velocity would work for all other hails
-                    const bool solves_xz{
-                        algo::all_of(hail | std::views::drop(2),
-                                     [&](const Hail& rhs)
-                                     {
-                                         const int64_t this_z{ get_stone_z_vel_from_intersection(
-                                             hail[0], rhs, stone_vel, first_intersection_xy.value()) };
-                                         if (this_z != Z)
-                                         {
-                                             return false;
-                                         }
-                                         return true;
-                                     })
-                    };
-                    if (!solves_xz)
-                    {
-                        continue;
-                    }
+            if (distance % closing_speed != 0)
+            {
+                return false;
+            }
 
-                    // Here we found a velocity that solves our problem  \o.o/
-                    //  all that is left is to compute the time at which the first stone hits the original
-                    //  intersection in the XY-plane and back-compute the position of the stone
-                    const double t{
-                        get_time_at_intersection(hail[0], stone_vel_with_z, first_intersection_xy.value())
-                    };
-                    const Vec3 pos{
-                        first_intersection_xy->At.X,
-                        first_intersection_xy->At.Y,
-                        hail[0].Pos.Z + static_cast<int64_t>(t) * (hail[0].Vel.Z - Z),
-                    };
-                    const Vec3 vel{ stone_vel_with_z };
-                    fmt::print("Found solution: {}, {}, {} @ {}, {}, {}\n",
-                               pos.X,
-                               pos.Y,
-                               pos.Z,
-                               vel.X,
-                               vel.Y,
-                               vel.Z);
+            const int128_t t{ distance / closing_speed };
+            if (t < 0 || (hit_t.has_value() && hit_t.value() != t))
+            {
+                return false;
+            }
+            hit_t = t;
+        }
+        return true;
+    };
 
-                    const int64_t init_pos_sum{ pos.X + pos.Y + pos.Z };
-                    fmt::print("The result is: {}", init_pos_sum);
-                    return init_pos_sum != 886858737029295;
-                }
+    // Any three hail that are not degenerate determine the stone, but make sure it hits everything else
+    for (size_t i = 1; i < hail.size(); i++)
+    {
+        for (size_t j = i + 1; j < hail.size(); j++)
+        {
+            const std::optional stone{ solve_stone(hail[0], hail[i], hail[j]) };
+            if (!stone.has_value() || !algo::all_of(hail, [&](const Hail& rhs)
+                                                    { return hits(stone.value(), rhs); }))
+            {
+                continue;
             }
+
+            const auto& [pos, vel]{ stone.value() };
+            fmt::print("Found solution: {}, {}, {} @ {}, {}, {}\n",
+                       pos.X,
+                       pos.Y,
+                       pos.Z,
+                       vel.X,
+                       vel.Y,
+                       vel.Z);
+
+            const int64_t init_pos_sum{ pos.X + pos.Y + pos.Z };
+            fmt::print("The result is: {}", init_pos_sum);
+            return init_pos_sum != 886858737029295;
         }
     }
-    std::unreachable();
+
+    fmt::print("No stone hits all hail...");
+    return 1;
 }
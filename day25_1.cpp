@@ -1,19 +1,14 @@
-﻿#include <cassert>
+﻿#include <algorithm>
 #include <cctype>
-#include <compare>
-#include <queue>
+#include <cstdint>
+#include <optional>
 #include <ranges>
 #include <string_view>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
-
-struct Node
-{
-    std::string_view Name;
-    std::string_view Connections;
-};
+#include "graph.h"
 
 int main(int argc, char** argv)
 {
@@ -23,131 +18,115 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    static constexpr auto to_vector{ std::ranges::to<std::vector>() };
     static constexpr auto lines{ std::views::split('\n') };
     static constexpr auto to_string_views{ std::views::transform(
         [](auto str)
         { return algo::trim(std::string_view(str.data(), str.size())); }) };
 
-    static constexpr auto to_nodes{ std::views::transform(
-        [](auto str)
-        {
-            const std::vector parts{ str | std::views::split(':') | to_string_views | to_vector };
-            return Node{ parts[0], parts[1] };
-        }) };
-
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
-    const std::vector nodes_direct{ file_data | lines | to_string_views | to_nodes | to_vector };
-    const std::vector nodes{
+    // Every connection is added in both directions, so each arc is linked to its reverse arc
+    const Graph wiring{
         [&]()
         {
-            std::vector<Node> nodes{ nodes_direct };
-            for (const Node& node : nodes_direct)
+            GraphBuilder builder{};
+            for (const std::string_view line : file_data | lines | to_string_views)
             {
-                for (const auto& other_name : node.Connections | std::views::split(' ') | to_string_views)
+                const size_t colon{ line.find(':') };
+                const uint32_t lhs{ builder.intern(line.substr(0, colon)) };
+                for (const std::string_view rhs_name : line.substr(colon + 1) | std::views::split(' ') | to_string_views)
                 {
-                    const auto* other{ algo::find(nodes, &Node::Name, other_name) };
-                    if (other == nullptr)
+                    if (!rhs_name.empty())
                     {
-                        nodes.push_back(Node{ other_name });
+                        builder.add_undirected_edge(lhs, builder.intern(rhs_name));
                     }
                 }
             }
-            return nodes;
+            return std::move(builder).build();
         }()
     };
 
-    const std::string digraph{
-        [&]()
+    // Every connection carries one unit of flow in either direction, so the maximum flow between two
+    // components is the number of connections that have to be cut to separate them. Components on the other
+    // side of the three-connection cut have a maximum flow of exactly three to the first component, at that
+    // point all components reachable without saturated connections make up the first group
+    static constexpr size_t c_NumCuts{ 3 };
+    const auto find_cut = [&](uint32_t source, uint32_t sink) -> std::optional<std::pair<size_t, size_t>>
+    {
+        std::vector<int8_t> flow(wiring.num_edges(), 0);
+        std::vector<uint32_t> reached_by(wiring.num_nodes());
+
+        // Breadth-first search for a path along connections that can still carry flow, returns all
+        // number of components reached when there is none
+        const auto find_path = [&]()
         {
-            std::string str;
-            for (const auto& lhs : nodes)
+            bool found_sink{ false };
+            const NodeSet reached{ algo::breadth_first_search(
+                wiring, source, [&](uint32_t arc)
+                { return flow[arc] < 1; },
+                [&](uint32_t component, uint32_t arc)
+                {
+                    reached_by[component] = arc;
+                    found_sink = component == sink;
+                    return !found_sink;
+                }) };
+            return found_sink ? std::nullopt : std::optional{ reached.size() };
+        };
+
+        for (size_t num_paths = 0; num_paths <= c_NumCuts; num_paths++)
+        {
+            if (const std::optional<size_t> group_size{ find_path() })
             {
-                for (const auto& rhs_name : lhs.Connections | std::views::split(' ') | to_string_views)
+                if (num_paths != c_NumCuts)
                 {
-                    str += fmt::format("\t{} -> {}\n", lhs.Name, rhs_name);
+                    return std::nullopt;
                 }
+                return std::pair{ group_size.value(), wiring.num_nodes() - group_size.value() };
             }
-            return fmt::format("digraph{{\n{}}}", str);
-        }()
-    };
-
-    fmt::print("Inspect the digraph:\n{}\n", digraph);
-    fmt::print("Enter the three connections to cut, separate the two nodes by space...\n");
-
-    static constexpr auto read_connection_from_stdin = [](std::string_view label)
-    {
-        fmt::print("{}:", label);
-
-        std::pair<std::string, std::string> conn{};
-        std::cin >> conn.first;
-        std::cin >> conn.second;
-        return conn;
-    };
 
-    const auto [lhs_a, rhs_a] = read_connection_from_stdin(" First");
-    const auto [lhs_b, rhs_b] = read_connection_from_stdin("Second");
-    const auto [lhs_c, rhs_c] = read_connection_from_stdin(" Third");
-
-    const std::unordered_map tree{
-        [&]()
-        {
-            std::unordered_map<std::string_view, std::unordered_set<const Node*>> tree;
-            for (const Node& lhs : nodes)
+            for (uint32_t component = sink; component != source;)
             {
-                for (const auto& rhs_name : lhs.Connections | std::views::split(' ') | to_string_views)
-                {
-                    const auto should_cut = [&](const auto& lhs_cut, const auto& rhs_cut)
-                    {
-                        if ((lhs.Name == lhs_cut && rhs_name == rhs_cut) ||
-                            (lhs.Name == rhs_cut && rhs_name == lhs_cut))
-                        {
-                            fmt::print("Cut connection {} <-> {}...\n", lhs_cut, rhs_cut);
-                            return true;
-                        }
-                        return false;
-                    };
-                    if (should_cut(lhs_a, rhs_a) || should_cut(lhs_b, rhs_b) || should_cut(lhs_c, rhs_c))
-                    {
-                        continue;
-                    }
-
-                    const auto* rhs{ algo::find(nodes, &Node::Name, rhs_name) };
-                    assert(rhs);
-                    tree[rhs_name].insert(&lhs);
-                    tree[lhs.Name].insert(rhs);
-                }
+                const uint32_t arc{ reached_by[component] };
+                flow[arc]++;
+                flow[wiring.reverse(arc)]--;
+                component = wiring.target(wiring.reverse(arc));
             }
-            return tree;
-        }()
+        }
+        return std::nullopt;
     };
 
-    const size_t lhs_tree_size{
-        [&]()
+    // Components far away from the first one are the most likely to be on the other side of the cut
+    std::vector<uint32_t> by_distance;
+    algo::breadth_first_search(
+        wiring, 0, [](uint32_t)
+        { return true; },
+        [&](uint32_t component, uint32_t)
         {
-            std::unordered_set<const Node*> visited;
-            const auto visit_node = [&](this const auto& self, const Node* node)
-            {
-                if (visited.contains(node))
-                {
-                    return;
-                }
-                visited.insert(node);
+            by_distance.push_back(component);
+            return true;
+        });
 
-                for (const Node* other : tree.at(node->Name))
-                {
-                    self(other);
-                }
-            };
-            visit_node(&nodes[0]);
-            return visited.size();
-        }()
-    };
-    const size_t rhs_tree_size{ nodes.size() - lhs_tree_size };
+    std::optional<std::pair<size_t, size_t>> groups{ std::nullopt };
+    for (const uint32_t sink : by_distance | std::views::drop(1) | std::views::reverse)
+    {
+        groups = find_cut(0, sink);
+        if (groups.has_value())
+        {
+            break;
+        }
+    }
+
+    if (!groups.has_value())
+    {
+        fmt::print("No way to split the components by cutting {} connections...", c_NumCuts);
+        return 1;
+    }
+
+    const auto [lhs_group_size, rhs_group_size]{ groups.value() };
+    fmt::print("Groups of size {} and {}\n", lhs_group_size, rhs_group_size);
 
-    const size_t product_of_split_tree_sizes{ lhs_tree_size * rhs_tree_size };
-    fmt::print("The result is: {}", product_of_split_tree_sizes);
-    return product_of_split_tree_sizes != 495607;
+    const size_t product_of_group_sizes{ lhs_group_size * rhs_group_size };
+    fmt::print("The result is: {}", product_of_group_sizes);
+    return product_of_group_sizes != 495607;
 }
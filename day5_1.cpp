@@ -4,9 +4,9 @@
 #include <ranges>
 
 #include <fmt/format.h>
-#include <magic_enum.hpp>
 
 #include "algorithms.h"
+#include "perfect_hash.h"
 #include "tokenize_to_types.h"
 
 enum class Property
@@ -21,6 +21,9 @@ enum class Property
     Location,
 };
 
+// Names of all properties as they appear in the input, in the same order as Property
+using PropertyNames = PerfectHash<"seed", "soil", "fertilizer", "water", "light", "temperature", "humidity", "location">;
+
 struct PropertyMapping
 {
     Property From;
@@ -50,7 +53,7 @@ constexpr auto ToType<size_t>(std::string_view type_as_string)
 template<>
 constexpr auto ToType<Property>(std::string_view type_as_string)
 {
-    return magic_enum::enum_cast<Property>(type_as_string, magic_enum::case_insensitive).value();
+    return static_cast<Property>(PropertyNames::find(type_as_string).value());
 }
 
 template<>
@@ -79,7 +82,7 @@ constexpr auto ToType<PropertyMapping>(std::string_view type_as_string)
         const auto to_string_views{ std::views::transform([](auto sr)
                                                           { return std::string_view(sr.data(), sr.size()); }) };
         const auto is_property{ std::views::filter([](std::string_view str)
-                                                   { return magic_enum::enum_contains<Property>(str, magic_enum::case_insensitive); }) };
+                                                   { return PropertyNames::find(str).has_value(); }) };
         const auto to_property{ std::views::transform(&ToType<Property>) };
 
         const auto first_line{ *(std::views::split(type_as_string, '\n') | to_string_views).begin() };
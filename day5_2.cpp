@@ -4,9 +4,10 @@
 #include <ranges>
 
 #include <fmt/format.h>
-#include <magic_enum.hpp>
 
 #include "algorithms.h"
+#include "interval_set.h"
+#include "perfect_hash.h"
 #include "tokenize_to_types.h"
 
 enum class Property
@@ -21,11 +22,8 @@ enum class Property
     Location,
 };
 
-struct PropertyRange
-{
-    size_t Begin;
-    size_t End;
-};
+// Names of all properties as they appear in the input, in the same order as Property
+using PropertyNames = PerfectHash<"seed", "soil", "fertilizer", "water", "light", "temperature", "humidity", "location">;
 
 struct PropertyMapping
 {
@@ -43,7 +41,7 @@ struct PropertyMapping
 
 struct Almanac
 {
-    std::vector<PropertyRange> RequiredSeeds;
+    IntervalSet<size_t> RequiredSeeds;
     std::vector<PropertyMapping> Mappings;
 };
 
@@ -56,7 +54,7 @@ constexpr auto ToType<size_t>(std::string_view type_as_string)
 template<>
 constexpr auto ToType<Property>(std::string_view type_as_string)
 {
-    return magic_enum::enum_cast<Property>(type_as_string, magic_enum::case_insensitive).value();
+    return static_cast<Property>(PropertyNames::find(type_as_string).value());
 }
 
 template<>
@@ -85,7 +83,7 @@ constexpr auto ToType<PropertyMapping>(std::string_view type_as_string)
         const auto to_string_views{ std::views::transform([](auto sr)
                                                           { return std::string_view(sr.data(), sr.size()); }) };
         const auto is_property{ std::views::filter([](std::string_view str)
-                                                   { return magic_enum::enum_contains<Property>(str, magic_enum::case_insensitive); }) };
+                                                   { return PropertyNames::find(str).has_value(); }) };
         const auto to_property{ std::views::transform(&ToType<Property>) };
 
         const auto first_line{ *(std::views::split(type_as_string, '\n') | to_string_views).begin() };
@@ -114,10 +112,10 @@ constexpr auto ToType<Almanac>(std::string_view type_as_string)
         {
             const size_t from{ chunk[0] };
             const size_t size{ chunk[1] };
-            return PropertyRange{ from, from + size };
+            return Interval<size_t>{ from, from + size };
         });
     return Almanac{
-        raw_seeds_list | std::views::chunk(2) | to_seed_range | std::ranges::to<std::vector>(),
+        raw_seeds_list | std::views::chunk(2) | to_seed_range | std::ranges::to<IntervalSet<size_t>>(),
         paragraphs | std::views::drop(1) | std::views::transform(&ToType<PropertyMapping>) | std::ranges::to<std::vector>(),
     };
 }
@@ -135,7 +133,7 @@ int main(int argc, char** argv)
 
     const Almanac almanac{ ToType<Almanac>(file_data) };
 
-    const auto do_mapping = [&](std::vector<PropertyRange> value, Property from, Property to, auto& self) -> std::vector<PropertyRange>
+    const auto do_mapping = [&](IntervalSet<size_t> value, Property from, Property to, auto& self) -> IntervalSet<size_t>
     {
         while (std::to_underlying(to) - std::to_underlying(from) > 1)
         {
@@ -146,78 +144,26 @@ int main(int argc, char** argv)
 
         const PropertyMapping& mapping{ *algo::find(almanac.Mappings, &PropertyMapping::From, from) };
 
-        std::vector<PropertyRange> out_ranges{};
-        for (auto it = value.begin(); it != value.end();)
+        // Values covered by any range are moved by its offset, all other values stay where they are. Pieces are
+        // collected first so each set is sorted and coalesced only once
+        std::vector<Interval<size_t>> mapped_pieces{};
+        std::vector<Interval<size_t>> sources{};
+        for (const auto& [from_begin, from_end, to_begin] : mapping.Ranges)
         {
-            bool exhausted{ false };
-
-            for (const auto& [from_begin, from_end, to_begin] : mapping.Ranges)
-            {
-                const auto& [input_begin, input_end] = *it;
-
-                const size_t overlap_begin{
-                    input_begin < from_begin
-                        ? from_begin
-                        : input_begin,
-                };
-                const size_t overlap_end{
-                    input_end > from_end
-                        ? from_end
-                        : input_end,
-                };
-                if (overlap_begin < overlap_end)
-                {
-                    const size_t mapped_begin{ static_cast<size_t>(to_begin + (overlap_begin - from_begin)) };
-                    const size_t mapped_end{ static_cast<size_t>(to_begin + (overlap_end - from_begin)) };
-                    PropertyRange mapped_range{ mapped_begin, mapped_end };
-                    out_ranges.push_back(mapped_range);
-
-                    if (overlap_begin == input_begin && overlap_end == input_end)
-                    {
-                        it = value.erase(it);
-                        exhausted = true;
-                        break;
-                    }
-                    else if (overlap_begin == input_begin)
-                    {
-                        PropertyRange adjusted_range{ overlap_end, input_end };
-                        *it = adjusted_range;
-                    }
-                    else if (overlap_end == input_end)
-                    {
-                        PropertyRange adjusted_range{ input_begin, overlap_begin };
-                        *it = adjusted_range;
-                    }
-                    else
-                    {
-                        PropertyRange adjusted_range{ input_begin, overlap_begin };
-                        *it = adjusted_range;
-
-                        PropertyRange new_range{ overlap_end, input_end };
-                        it = value.insert(it, new_range);
-                    }
-                }
-            }
-
-            if (!exhausted)
+            const Interval<size_t> source{ from_begin, from_end };
+            for (const Interval<size_t>& piece : (value & source).shifted(to_begin - from_begin))
             {
-                ++it;
+                mapped_pieces.push_back(piece);
             }
+            sources.push_back(source);
         }
-
-        out_ranges.insert(out_ranges.end(), value.begin(), value.end());
-
-        return out_ranges;
-    };
-    const auto map_seed_to_location = [&](PropertyRange value)
-    {
-        return do_mapping(std::vector{ value }, Property::Seed, Property::Location, do_mapping);
+        const IntervalSet<size_t> covered{ std::from_range, sources };
+        return IntervalSet<size_t>{ std::from_range, mapped_pieces } | (value - covered);
     };
 
-    std::vector locations{ almanac.RequiredSeeds | std::views::transform(map_seed_to_location) | std::views::join | std::ranges::to<std::vector>() };
-    std::vector lowest_locations{ locations | std::views::transform(&PropertyRange::Begin) | std::ranges::to<std::vector>() };
+    const IntervalSet locations{ do_mapping(almanac.RequiredSeeds, Property::Seed, Property::Location, do_mapping) };
 
-    const size_t lowest_location{ algo::min_element(lowest_locations) };
+    const size_t lowest_location{ locations.front().Begin };
     fmt::print("The result is: {}", lowest_location);
 
     return lowest_location != 52210644;
@@ -2,23 +2,17 @@
 
 #include <cctype>
 #include <ranges>
-#include <unordered_map>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "graph.h"
 #include "tokenize.h"
 
-struct Map
+struct Crossing
 {
-    std::string_view Directions;
-
-    struct Crossing
-    {
-        std::string_view Left;
-        std::string_view Right;
-    };
-    std::unordered_map<std::string_view, Crossing> Crossings;
+    std::string_view Left;
+    std::string_view Right;
 };
 
 int main(int argc, char** argv)
@@ -33,7 +27,6 @@ int main(int argc, char** argv)
         [](auto str)
         { return algo::trim(std::string_view(str.data(), str.size())); }) };
     static constexpr auto to_vector{ std::ranges::to<std::vector>() };
-    static constexpr auto to_umap{ std::ranges::to<std::unordered_map>() };
 
     static constexpr auto to_pair{
         [](auto range)
@@ -56,7 +49,7 @@ int main(int argc, char** argv)
                     return "()"sv.contains(c);
                 };
                 auto [left, right]{ to_pair(algo::trim(towards_str, is_bracket) | std::views::split(',') | to_string_views) };
-                return std::pair{ starting, Map::Crossing{ left, right } };
+                return std::pair{ starting, Crossing{ left, right } };
             }),
     };
 
@@ -64,17 +57,35 @@ int main(int argc, char** argv)
     const std::string file_data{ algo::read_whole_file(input_file) };
 
     const auto [directions, crossings_str]{ to_pair(algo::split<"\n\n">(file_data)) };
-    const auto crossings{ crossings_str | std::views::split('\n') | to_crossing | to_umap };
 
-    std::string_view at{ "AAA" };
+    // Every crossing leads left through its first edge and right through its second edge
+    const Graph network{
+        [&]()
+        {
+            GraphBuilder builder{};
+            for (const auto& [starting, crossing] : crossings_str | std::views::split('\n') | to_crossing)
+            {
+                const uint32_t from{ builder.intern(starting) };
+                builder.add_edge(from, builder.intern(crossing.Left));
+                builder.add_edge(from, builder.intern(crossing.Right));
+            }
+            return std::move(builder).build();
+        }()
+    };
+    const auto turn = [&](uint32_t at, char direction)
+    {
+        return network.target(network.edges_begin(at) + (direction == 'L' ? 0 : 1));
+    };
+
+    uint32_t at{ network.find("AAA").value() };
+    const uint32_t goal{ network.find("ZZZ").value() };
     size_t num_turns{ 0 };
     do
     {
         const auto direction{ directions[num_turns % directions.size()] };
-        const auto& crossing{ crossings.at(at) };
-        at = direction == 'L' ? crossing.Left : crossing.Right;
+        at = turn(at, direction);
         num_turns++;
-    } while (at != "ZZZ");
+    } while (at != goal);
 
     fmt::print("The result is: {}", num_turns);
 
@@ -3,23 +3,17 @@
 #include <cassert>
 #include <cctype>
 #include <ranges>
-#include <unordered_map>
 
 #include <fmt/format.h>
 
 #include "algorithms.h"
+#include "graph.h"
 #include "tokenize.h"
 
-struct Map
+struct Crossing
 {
-    std::string_view Directions;
-
-    struct Crossing
-    {
-        std::string_view Left;
-        std::string_view Right;
-    };
-    std::unordered_map<std::string_view, Crossing> Crossings;
+    std::string_view Left;
+    std::string_view Right;
 };
 
 int main(int argc, char** argv)
@@ -34,7 +28,6 @@ int main(int argc, char** argv)
         [](auto str)
         { return algo::trim(std::string_view(str.data(), str.size())); }) };
     static constexpr auto to_vector{ std::ranges::to<std::vector>() };
-    static constexpr auto to_umap{ std::ranges::to<std::unordered_map>() };
 
     static constexpr auto to_pair{
         [](auto range)
@@ -57,24 +50,41 @@ int main(int argc, char** argv)
                     return "()"sv.contains(c);
                 };
                 auto [left, right]{ to_pair(algo::trim(towards_str, is_bracket) | std::views::split(',') | to_string_views) };
-                return std::pair{ starting, Map::Crossing{ left, right } };
+                return std::pair{ starting, Crossing{ left, right } };
             }),
     };
 
-    static constexpr auto to_start{ std::views::transform([](const auto& entry)
-                                                          { return entry.first; }) };
-    static constexpr auto to_ghost_start{ std::views::filter([](const auto& start)
-                                                             { return start.ends_with('A'); }) };
-
     const std::string_view input_file{ argv[1] };
     const std::string file_data{ algo::read_whole_file(input_file) };
 
     const auto [directions, crossings_str]{ to_pair(algo::split<"\n\n">(file_data)) };
-    const auto crossings{ crossings_str | std::views::split('\n') | to_crossing | to_umap };
+
+    // Every crossing leads left through its first edge and right through its second edge
+    const Graph network{
+        [&]()
+        {
+            GraphBuilder builder{};
+            for (const auto& [starting, crossing] : crossings_str | std::views::split('\n') | to_crossing)
+            {
+                const uint32_t from{ builder.intern(starting) };
+                builder.add_edge(from, builder.intern(crossing.Left));
+                builder.add_edge(from, builder.intern(crossing.Right));
+            }
+            return std::move(builder).build();
+        }()
+    };
+    const auto turn = [&](uint32_t at, char direction)
+    {
+        return network.target(network.edges_begin(at) + (direction == 'L' ? 0 : 1));
+    };
 
     std::vector<size_t> cycle_lengths{};
     {
-        std::vector all_at{ crossings | to_start | to_ghost_start | to_vector };
+        const auto is_ghost_start = [&](uint32_t node)
+        {
+            return network.name(node).ends_with('A');
+        };
+        std::vector all_at{ std::views::iota(uint32_t{ 0 }, network.num_nodes()) | std::views::filter(is_ghost_start) | to_vector };
         size_t num_turns{ 0 };
         while (!all_at.empty())
         {
@@ -82,10 +92,9 @@ int main(int argc, char** argv)
             num_turns++;
             for (auto it = all_at.begin(); it != all_at.end();)
             {
-                auto& at{ *it };
-                const auto& crossing{ crossings.at(at) };
-                at = direction == 'L' ? crossing.Left : crossing.Right;
-                if (at.ends_with('Z'))
+                uint32_t& at{ *it };
+                at = turn(at, direction);
+                if (network.name(at).ends_with('Z'))
                 {
                     cycle_lengths.push_back(num_turns);
                     it = all_at.erase(it);
@@ -0,0 +1,101 @@
+#include "corridor_graph.h"
+
+#include <array>
+
+namespace algo
+{
+CorridorGraph compress_corridors(std::string_view grid, size_t stride, std::span<const size_t> endpoints, SlopeBehavior slopes)
+{
+    static constexpr std::string_view c_Slopes{ ">v<^" };
+    const std::array<int64_t, 4> offsets{ 1, static_cast<int64_t>(stride), -1, -static_cast<int64_t>(stride) };
+
+    const auto is_open = [&](size_t pos)
+    {
+        return pos < grid.size() && (grid[pos] == '.' || c_Slopes.contains(grid[pos]));
+    };
+    const auto neighbour = [&](size_t pos, size_t dir)
+    {
+        // Wraps around to a huge index when stepping off the front of the grid, which is out of bounds
+        return static_cast<size_t>(static_cast<int64_t>(pos) + offsets[dir]);
+    };
+    const auto can_leave = [&](size_t pos, size_t dir)
+    {
+        return slopes == SlopeBehavior::Ignore || grid[pos] == '.' || c_Slopes[dir] == grid[pos];
+    };
+
+    CorridorGraph graph{};
+    graph.NodeOf.assign(grid.size(), CorridorGraph::c_NoNode);
+    const auto add_node = [&](size_t pos)
+    {
+        graph.NodeOf[pos] = graph.num_nodes();
+        graph.Positions.push_back(pos);
+    };
+
+    for (const size_t pos : endpoints)
+    {
+        add_node(pos);
+    }
+    for (size_t pos = 0; pos < grid.size(); pos++)
+    {
+        if (!is_open(pos) || graph.NodeOf[pos] != CorridorGraph::c_NoNode)
+        {
+            continue;
+        }
+
+        size_t num_open{ 0 };
+        for (size_t dir = 0; dir < 4; dir++)
+        {
+            num_open += is_open(neighbour(pos, dir)) ? 1 : 0;
+        }
+        if (num_open > 2)
+        {
+            add_node(pos);
+        }
+    }
+
+    // Walk every corridor from each of its ends, so each tile is only visited twice in total
+    graph.EdgeOffsets.push_back(0);
+    for (uint32_t node = 0; node < graph.num_nodes(); node++)
+    {
+        const size_t start{ graph.Positions[node] };
+        for (size_t first_dir = 0; first_dir < 4; first_dir++)
+        {
+            if (!is_open(neighbour(start, first_dir)) || !can_leave(start, first_dir))
+            {
+                continue;
+            }
+
+            size_t previous{ start };
+            size_t current{ neighbour(start, first_dir) };
+            uint32_t length{ 1 };
+            bool passable{ true };
+            while (passable && graph.NodeOf[current] == CorridorGraph::c_NoNode)
+            {
+                passable = false;
+                for (size_t dir = 0; dir < 4; dir++)
+                {
+                    const size_t next{ neighbour(current, dir) };
+                    if (next != previous && is_open(next))
+                    {
+                        passable = can_leave(current, dir);
+                        previous = current;
+                        current = next;
+                        length++;
+                        break;
+                    }
+                }
+            }
+
+            const uint32_t target{ graph.NodeOf[current] };
+            if (passable && target != node)
+            {
+                graph.EdgeTargets.push_back(target);
+                graph.EdgeLengths.push_back(length);
+            }
+        }
+        graph.EdgeOffsets.push_back(static_cast<uint32_t>(graph.EdgeTargets.size()));
+    }
+
+    return graph;
+}
+} // namespace algo
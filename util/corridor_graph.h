@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+enum class SlopeBehavior
+{
+    // Slopes are walked like any other open tile
+    Ignore,
+    // Slopes '^', '>', 'v' and '<' can only be left in the direction they point to
+    OneWay,
+};
+
+// A maze compressed to its junctions, every corridor between two of them becomes a weighted edge.
+// Edges are stored in compressed sparse row form, those leaving node i are [EdgeOffsets[i], EdgeOffsets[i + 1])
+struct CorridorGraph
+{
+    static constexpr uint32_t c_NoNode{ UINT32_MAX };
+
+    std::vector<size_t> Positions;
+    std::vector<uint32_t> NodeOf;
+    std::vector<uint32_t> EdgeOffsets;
+    std::vector<uint32_t> EdgeTargets;
+    std::vector<uint32_t> EdgeLengths;
+
+    uint32_t num_nodes() const
+    {
+        return static_cast<uint32_t>(Positions.size());
+    }
+    std::span<const uint32_t> targets(uint32_t node) const
+    {
+        return std::span{ EdgeTargets }.subspan(EdgeOffsets[node], EdgeOffsets[node + 1] - EdgeOffsets[node]);
+    }
+    std::span<const uint32_t> lengths(uint32_t node) const
+    {
+        return std::span{ EdgeLengths }.subspan(EdgeOffsets[node], EdgeOffsets[node + 1] - EdgeOffsets[node]);
+    }
+};
+
+namespace algo
+{
+// Compresses a flat grid where every row is stride tiles long, anything but '.' and slopes is a wall so
+// line breaks can stay in the grid. Nodes are the given endpoints, in order, followed by all tiles with
+// more than two open neighbours. Corridors ending in a dead end do not produce edges
+CorridorGraph compress_corridors(std::string_view grid, size_t stride, std::span<const size_t> endpoints, SlopeBehavior slopes);
+} // namespace algo
@@ -0,0 +1,104 @@
+#include "crucible.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+namespace algo
+{
+std::optional<size_t> find_minimum_heatloss(const std::vector<std::vector<size_t>>& city, size_t min_run, size_t max_run)
+{
+    const int64_t width{ static_cast<int64_t>(city.front().size()) };
+    const int64_t height{ static_cast<int64_t>(city.size()) };
+
+    // A state is a block plus the axis the crucible arrived on, every straight run is a single
+    // move so the next one always has to turn onto the other axis
+    struct State
+    {
+        int64_t X;
+        int64_t Y;
+        size_t Axis;
+    };
+    const auto out_of_bounds = [&](const State& state)
+    {
+        return state.X < 0 ||
+               state.Y < 0 ||
+               state.X >= width ||
+               state.Y >= height;
+    };
+
+    std::vector<uint64_t> visited(static_cast<size_t>(width * height * 2 + 63) / 64, 0);
+    const auto state_bit = [&](const State& state)
+    {
+        const size_t index{ static_cast<size_t>(state.Y * width + state.X) * 2 + state.Axis };
+        return std::pair{ index / 64, uint64_t{ 1 } << (index % 64) };
+    };
+    const auto is_visited = [&](const State& state)
+    {
+        const auto [word, bit]{ state_bit(state) };
+        return (visited[word] & bit) != 0;
+    };
+
+    // Dial's algorithm, a single move costs at most 9 per block so a ring of buckets indexed by
+    // heat loss covers everything that can be pending at once
+    std::vector<std::vector<State>> buckets(9 * max_run + 1);
+    size_t num_pending{ 0 };
+    const auto push = [&](const State& state, size_t heat_loss)
+    {
+        buckets[heat_loss % buckets.size()].push_back(state);
+        num_pending++;
+    };
+    push(State{ 0, 0, 0 }, 0);
+    push(State{ 0, 0, 1 }, 0);
+
+    for (size_t heat_loss = 0; num_pending > 0; heat_loss++)
+    {
+        std::vector<State>& bucket{ buckets[heat_loss % buckets.size()] };
+        while (!bucket.empty())
+        {
+            const State state{ bucket.back() };
+            bucket.pop_back();
+            num_pending--;
+
+            if (is_visited(state))
+            {
+                continue;
+            }
+            const auto [word, bit]{ state_bit(state) };
+            visited[word] |= bit;
+
+            const bool on_target{
+                state.X == width - 1 &&
+                state.Y == height - 1
+            };
+            if (on_target)
+            {
+                return heat_loss;
+            }
+
+            const size_t axis{ 1 - state.Axis };
+            for (const int64_t step : { int64_t{ -1 }, int64_t{ 1 } })
+            {
+                State next{ state.X, state.Y, axis };
+                size_t next_heat_loss{ heat_loss };
+                for (size_t i = 1; i <= max_run; i++)
+                {
+                    (axis == 0 ? next.X : next.Y) += step;
+                    if (out_of_bounds(next))
+                    {
+                        break;
+                    }
+
+                    next_heat_loss += city[next.Y][next.X];
+                    if (i >= min_run && !is_visited(next))
+                    {
+                        push(next, next_heat_loss);
+                    }
+                }
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+} // namespace algo
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+namespace algo
+{
+// Least heat lost moving a crucible from the top left to the bottom right block of city, every straight run
+// covers between min_run and max_run blocks before the crucible has to turn, nullopt if it cannot get there
+std::optional<size_t> find_minimum_heatloss(const std::vector<std::vector<size_t>>& city, size_t min_run, size_t max_run);
+} // namespace algo
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "flat_map.h"
+
+// States repeat from step Start on with period Length, step 0 being the initial state
+struct Cycle
+{
+    size_t Start;
+    size_t Length;
+
+    // Step below Start + Length that is in the same state as step
+    constexpr size_t equivalent_step(size_t step) const
+    {
+        return step < Start + Length ? step : Start + (step - Start) % Length;
+    }
+};
+
+namespace algo
+{
+// Applies step(state) until a state repeats, only remembering the hash of each state so memory stays at
+// one entry per step until the first repeat. Anything needed later, e.g. to extrapolate to some far away
+// step via Cycle::equivalent_step, has to be recorded by step itself
+template<class StateT, class StepT, class HashT>
+Cycle find_cycle(StateT state, StepT step, HashT hash)
+{
+    FlatMap<uint64_t, size_t> seen{ { hash(std::as_const(state)), 0 } };
+    for (size_t i = 1;; i++)
+    {
+        step(state);
+        const auto [it, inserted]{ seen.try_emplace(hash(std::as_const(state)), i) };
+        if (!inserted)
+        {
+            return Cycle{ it->second, i - it->second };
+        }
+    }
+}
+
+// Same as above but verifies every hash hit by comparing the states, for hashes that are too weak to trust
+// on their own. Instead of keeping earlier states around, an earlier step is rebuilt by replaying step from
+// the initial state, so memory stays at one entry per step. Since step is replayed it must not have side
+// effects, anything needed later has to be recomputed from the initial state instead
+template<class StateT, class StepT, class HashT, class EqualT>
+Cycle find_cycle(StateT state, StepT step, HashT hash, EqualT equal)
+{
+    // Each step links to the previous step with the same hash, c_NoStep ends the chain
+    static constexpr size_t c_NoStep{ static_cast<size_t>(-1) };
+    const StateT initial{ state };
+    std::vector<size_t> previous{ c_NoStep };
+    FlatMap<uint64_t, size_t> latest{ { hash(std::as_const(state)), 0 } };
+    std::vector<size_t> candidates;
+    for (size_t i = 1;; i++)
+    {
+        step(state);
+        const auto [it, inserted]{ latest.try_emplace(hash(std::as_const(state)), i) };
+        if (!inserted)
+        {
+            // Replay once from the start, comparing against every earlier step with the same hash on the way
+            candidates.clear();
+            for (size_t j = it->second; j != c_NoStep; j = previous[j])
+            {
+                candidates.push_back(j);
+            }
+
+            StateT replayed{ initial };
+            size_t replayed_step{ 0 };
+            for (const size_t candidate : candidates | std::views::reverse)
+            {
+                for (; replayed_step < candidate; replayed_step++)
+                {
+                    step(replayed);
+                }
+                if (equal(std::as_const(replayed), std::as_const(state)))
+                {
+                    return Cycle{ candidate, i - candidate };
+                }
+            }
+        }
+        previous.push_back(inserted ? c_NoStep : std::exchange(it->second, i));
+    }
+}
+} // namespace algo
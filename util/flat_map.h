@@ -0,0 +1,484 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AOC_FLAT_MAP_SSE2
+#endif
+
+// A string_view that copies strings of up to 15 characters into itself, so comparing short keys never
+// touches the string they were made from. Longer strings are only referenced, same as a string_view. Views
+// of short keys point into the key itself, so converting back to a string_view has to be explicit
+class SmallStringKey
+{
+  public:
+    SmallStringKey(std::string_view str)
+    {
+        if (str.size() <= c_MaxInline)
+        {
+            std::memcpy(m_Storage.data(), str.data(), str.size());
+            m_Storage[c_MaxInline] = static_cast<char>(str.size());
+        }
+        else
+        {
+            const char* data{ str.data() };
+            const uint32_t size{ static_cast<uint32_t>(str.size()) };
+            std::memcpy(m_Storage.data(), &data, sizeof(data));
+            std::memcpy(m_Storage.data() + sizeof(data), &size, sizeof(size));
+            m_Storage[c_MaxInline] = c_LongTag;
+        }
+    }
+
+    std::string_view view() const
+    {
+        if (m_Storage[c_MaxInline] != c_LongTag)
+        {
+            return std::string_view{ m_Storage.data(), static_cast<size_t>(m_Storage[c_MaxInline]) };
+        }
+
+        const char* data;
+        uint32_t size;
+        std::memcpy(&data, m_Storage.data(), sizeof(data));
+        std::memcpy(&size, m_Storage.data() + sizeof(data), sizeof(size));
+        return std::string_view{ data, size };
+    }
+    explicit operator std::string_view() const
+    {
+        return view();
+    }
+
+  private:
+    static constexpr size_t c_MaxInline{ 15 };
+    static constexpr char c_LongTag{ -1 };
+
+    std::array<char, c_MaxInline + 1> m_Storage{};
+};
+
+// How a key type is stored inside a FlatMap, lookups still use the key type itself
+template<class KeyT>
+struct FlatMapKeyStorage
+{
+    using type = KeyT;
+};
+template<>
+struct FlatMapKeyStorage<std::string_view>
+{
+    using type = SmallStringKey;
+};
+
+// Default hash of a FlatMap, names used as keys are short enough that inlined FNV-1a beats std::hash
+template<class KeyT>
+struct FlatMapHash : std::hash<KeyT>
+{
+};
+template<>
+struct FlatMapHash<std::string_view>
+{
+    static constexpr uint64_t c_Basis{ 14695981039346656037ull };
+
+    // Passing the hash of what came before str hashes both as if they were one string
+    size_t operator()(std::string_view str, uint64_t hash = c_Basis) const
+    {
+        for (const char c : str)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+// Same for runs of words, e.g. states kept as bitsets, one step per word instead of per byte
+template<>
+struct FlatMapHash<std::span<const uint64_t>>
+{
+    static constexpr uint64_t c_Basis{ FlatMapHash<std::string_view>::c_Basis };
+
+    size_t operator()(std::span<const uint64_t> words, uint64_t hash = c_Basis) const
+    {
+        for (const uint64_t word : words)
+        {
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+// Open addressing hash map that keeps all entries in one flat array. Every slot has a control byte holding
+// seven bits of its key's hash, lookups compare a whole group of 16 control bytes at once and only look at
+// slots whose bits match. Entries can't be erased, references are invalidated when the map grows
+template<class KeyT, class ValueT, class HashT = FlatMapHash<KeyT>, class KeyEqualT = std::equal_to<KeyT>>
+class FlatMap
+{
+  public:
+    using key_type = KeyT;
+    using mapped_type = ValueT;
+    using stored_key_type = typename FlatMapKeyStorage<KeyT>::type;
+    using value_type = std::pair<const stored_key_type, ValueT>;
+
+    template<bool IsConst>
+    class Iterator
+    {
+      public:
+        using MapT = std::conditional_t<IsConst, const FlatMap, FlatMap>;
+        using value_type = FlatMap::value_type;
+        using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+        using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        Iterator() = default;
+        Iterator(MapT* map, size_t index)
+            : m_Map{ map }
+            , m_Index{ index }
+        {
+            skip_empty();
+        }
+        operator Iterator<true>() const
+        requires(!IsConst)
+        {
+            return Iterator<true>{ m_Map, m_Index };
+        }
+
+        reference operator*() const
+        {
+            return m_Map->m_Slots[m_Index];
+        }
+        pointer operator->() const
+        {
+            return &m_Map->m_Slots[m_Index];
+        }
+
+        Iterator& operator++()
+        {
+            m_Index++;
+            skip_empty();
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator previous{ *this };
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& rhs) const
+        {
+            return m_Index == rhs.m_Index;
+        }
+
+      private:
+        void skip_empty()
+        {
+            while (m_Index < m_Map->m_Capacity && m_Map->m_Control[m_Index] == c_Empty)
+            {
+                m_Index++;
+            }
+        }
+
+        MapT* m_Map{ nullptr };
+        size_t m_Index{ 0 };
+    };
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatMap() = default;
+    template<class RangeT>
+    FlatMap(std::from_range_t, RangeT&& range)
+    {
+        if constexpr (std::ranges::sized_range<RangeT>)
+        {
+            reserve(std::ranges::size(range));
+        }
+        for (auto&& entry : range)
+        {
+            try_emplace(std::get<0>(entry), std::get<1>(std::forward<decltype(entry)>(entry)));
+        }
+    }
+    FlatMap(std::initializer_list<std::pair<KeyT, ValueT>> entries)
+        : FlatMap(std::from_range, entries)
+    {
+    }
+    FlatMap(const FlatMap& rhs)
+    {
+        reserve(rhs.size());
+        for (const auto& [key, value] : rhs)
+        {
+            try_emplace(as_key(key), value);
+        }
+    }
+    FlatMap(FlatMap&& rhs) noexcept
+    {
+        swap(rhs);
+    }
+    FlatMap& operator=(FlatMap rhs) noexcept
+    {
+        swap(rhs);
+        return *this;
+    }
+    ~FlatMap()
+    {
+        release();
+    }
+
+    void swap(FlatMap& rhs) noexcept
+    {
+        std::swap(m_Control, rhs.m_Control);
+        std::swap(m_Slots, rhs.m_Slots);
+        std::swap(m_Capacity, rhs.m_Capacity);
+        std::swap(m_Size, rhs.m_Size);
+    }
+
+    size_t size() const
+    {
+        return m_Size;
+    }
+    bool empty() const
+    {
+        return m_Size == 0;
+    }
+
+    iterator begin()
+    {
+        return iterator{ this, 0 };
+    }
+    iterator end()
+    {
+        return iterator{ this, m_Capacity };
+    }
+    const_iterator begin() const
+    {
+        return const_iterator{ this, 0 };
+    }
+    const_iterator end() const
+    {
+        return const_iterator{ this, m_Capacity };
+    }
+
+    iterator find(const KeyT& key)
+    {
+        return iterator{ this, find_index(key, hash(key)) };
+    }
+    const_iterator find(const KeyT& key) const
+    {
+        return const_iterator{ this, find_index(key, hash(key)) };
+    }
+    bool contains(const KeyT& key) const
+    {
+        return find_index(key, hash(key)) != m_Capacity;
+    }
+
+    ValueT& at(const KeyT& key)
+    {
+        return m_Slots[checked_index(key)].second;
+    }
+    const ValueT& at(const KeyT& key) const
+    {
+        return m_Slots[checked_index(key)].second;
+    }
+    ValueT& operator[](const KeyT& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    template<class... ArgsT>
+    std::pair<iterator, bool> try_emplace(const KeyT& key, ArgsT&&... args)
+    {
+        const uint64_t key_hash{ hash(key) };
+        if (const size_t index{ find_index(key, key_hash) }; index != m_Capacity)
+        {
+            return { iterator{ this, index }, false };
+        }
+
+        if ((m_Size + 1) * 8 > m_Capacity * 7)
+        {
+            grow(std::max(m_Capacity * 2, c_GroupSize));
+        }
+
+        const size_t index{ find_empty(key_hash) };
+        std::construct_at(&m_Slots[index], std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<ArgsT>(args)...));
+        m_Control[index] = control_bits(key_hash);
+        m_Size++;
+        return { iterator{ this, index }, true };
+    }
+
+    // Makes room for num_entries without growing, never shrinks
+    void reserve(size_t num_entries)
+    {
+        size_t capacity{ c_GroupSize };
+        while (num_entries * 8 > capacity * 7)
+        {
+            capacity *= 2;
+        }
+        if (capacity > m_Capacity)
+        {
+            grow(capacity);
+        }
+    }
+
+    // Removes all entries but keeps the memory around for reuse
+    void clear()
+    {
+        for (size_t i = 0; i < m_Capacity; i++)
+        {
+            if (m_Control[i] != c_Empty)
+            {
+                std::destroy_at(&m_Slots[i]);
+                m_Control[i] = c_Empty;
+            }
+        }
+        m_Size = 0;
+    }
+
+  private:
+    static constexpr size_t c_GroupSize{ 16 };
+    static constexpr int8_t c_Empty{ -128 };
+
+    static uint64_t hash(const KeyT& key)
+    {
+        // Spread the bits of weak hashes, std::hash of integers is the identity on most platforms
+        const uint64_t mixed{ static_cast<uint64_t>(HashT{}(key)) * 0x9E3779B97F4A7C15ull };
+        return mixed ^ (mixed >> 32);
+    }
+    static int8_t control_bits(uint64_t key_hash)
+    {
+        return static_cast<int8_t>(key_hash & 0x7F);
+    }
+    static decltype(auto) as_key(const stored_key_type& key)
+    {
+        if constexpr (std::is_same_v<stored_key_type, KeyT>)
+        {
+            return key;
+        }
+        else
+        {
+            return KeyT{ key };
+        }
+    }
+
+    // Bit i is set when control byte i of the group equals value
+    static uint32_t match_group(const int8_t* group, int8_t value)
+    {
+#ifdef AOC_FLAT_MAP_SSE2
+        const __m128i control{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(group)) };
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value))));
+#else
+        uint32_t mask{ 0 };
+        for (size_t i = 0; i < c_GroupSize; i++)
+        {
+            mask |= static_cast<uint32_t>(group[i] == value) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Groups are probed with growing strides, which visits every group once when there is a power of two of them
+    template<class FunT>
+    size_t probe(uint64_t key_hash, FunT&& fun) const
+    {
+        if (m_Capacity == 0)
+        {
+            return m_Capacity;
+        }
+
+        const size_t group_mask{ m_Capacity / c_GroupSize - 1 };
+        size_t group{ (key_hash >> 7) & group_mask };
+        for (size_t stride = 1;; stride++)
+        {
+            if (const std::optional<size_t> index{ fun(group * c_GroupSize) })
+            {
+                return index.value();
+            }
+            group = (group + stride) & group_mask;
+        }
+    }
+    size_t find_index(const KeyT& key, uint64_t key_hash) const
+    {
+        const int8_t bits{ control_bits(key_hash) };
+        return probe(
+            key_hash,
+            [&](size_t first) -> std::optional<size_t>
+            {
+                const int8_t* group{ &m_Control[first] };
+                for (uint32_t matches = match_group(group, bits); matches != 0; matches &= matches - 1)
+                {
+                    const size_t index{ first + static_cast<size_t>(std::countr_zero(matches)) };
+                    if (KeyEqualT{}(as_key(m_Slots[index].first), key))
+                    {
+                        return index;
+                    }
+                }
+                // A key is never placed past a group with free slots, so it can't be further along
+                return match_group(group, c_Empty) != 0 ? std::optional{ m_Capacity } : std::nullopt;
+            });
+    }
+    size_t checked_index(const KeyT& key) const
+    {
+        const size_t index{ find_index(key, hash(key)) };
+        if (index == m_Capacity)
+        {
+            throw std::out_of_range{ "FlatMap::at" };
+        }
+        return index;
+    }
+    size_t find_empty(uint64_t key_hash) const
+    {
+        return probe(
+            key_hash,
+            [&](size_t first) -> std::optional<size_t>
+            {
+                const uint32_t empty{ match_group(&m_Control[first], c_Empty) };
+                return empty != 0 ? std::optional{ first + static_cast<size_t>(std::countr_zero(empty)) } : std::nullopt;
+            });
+    }
+
+    void grow(size_t capacity)
+    {
+        FlatMap grown{};
+        grown.m_Control.assign(capacity, c_Empty);
+        grown.m_Slots = std::allocator<value_type>{}.allocate(capacity);
+        grown.m_Capacity = capacity;
+
+        for (size_t i = 0; i < m_Capacity; i++)
+        {
+            if (m_Control[i] != c_Empty)
+            {
+                const size_t index{ grown.find_empty(hash(as_key(m_Slots[i].first))) };
+                std::construct_at(&grown.m_Slots[index], std::move(m_Slots[i]));
+                grown.m_Control[index] = m_Control[i];
+            }
+        }
+        grown.m_Size = m_Size;
+        swap(grown);
+    }
+    void release()
+    {
+        if (m_Slots != nullptr)
+        {
+            clear();
+            std::allocator<value_type>{}.deallocate(m_Slots, m_Capacity);
+        }
+    }
+
+    std::vector<int8_t> m_Control;
+    value_type* m_Slots{ nullptr };
+    size_t m_Capacity{ 0 };
+    size_t m_Size{ 0 };
+};
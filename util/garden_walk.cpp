@@ -0,0 +1,66 @@
+#include "garden_walk.h"
+
+#include <bit>
+#include <utility>
+
+#include "algorithms.h"
+
+GardenWalk::GardenWalk(std::span<const std::string_view> garden, int64_t num_copies, Vec2 start)
+    : m_TileSize{ static_cast<int64_t>(garden.front().size()), static_cast<int64_t>(garden.size()) }
+    , m_Width{ m_TileSize.X * num_copies }
+    , m_Height{ m_TileSize.Y * num_copies }
+    , m_WordsPerRow{ static_cast<size_t>(m_Width + 63) / 64 }
+    , m_Open(m_WordsPerRow * m_Height, 0)
+    , m_Reached{ m_Open, m_Open }
+    , m_Frontier(m_Open)
+    , m_Next(m_Open)
+{
+    for (int64_t y = 0; y < m_Height; y++)
+    {
+        for (int64_t x = 0; x < m_Width; x++)
+        {
+            if (garden[y % m_TileSize.Y][x % m_TileSize.X] != '#')
+            {
+                set(m_Open, x, y);
+            }
+        }
+    }
+
+    const Vec2 center_start{ start + m_TileSize * (num_copies / 2) };
+    set(m_Frontier, center_start.X, center_start.Y);
+    set(m_Reached[0], center_start.X, center_start.Y);
+}
+
+void GardenWalk::step()
+{
+    std::vector<uint64_t>& reached{ m_Reached[(m_NumSteps + 1) % 2] };
+    for (size_t y = 0; y < static_cast<size_t>(m_Height); y++)
+    {
+        const uint64_t* above{ y > 0 ? row(m_Frontier, y - 1) : nullptr };
+        const uint64_t* current{ row(m_Frontier, y) };
+        const uint64_t* below{ y + 1 < static_cast<size_t>(m_Height) ? row(m_Frontier, y + 1) : nullptr };
+        const uint64_t* open{ row(m_Open, y) };
+        uint64_t* reached_row{ row(reached, y) };
+        uint64_t* next{ row(m_Next, y) };
+        for (size_t i = 0; i < m_WordsPerRow; i++)
+        {
+            const uint64_t from_left{ (current[i] << 1) | (i > 0 ? current[i - 1] >> 63 : 0) };
+            const uint64_t from_right{ (current[i] >> 1) | (i + 1 < m_WordsPerRow ? current[i + 1] << 63 : 0) };
+            const uint64_t from_above{ above != nullptr ? above[i] : 0 };
+            const uint64_t from_below{ below != nullptr ? below[i] : 0 };
+            next[i] = (from_left | from_right | from_above | from_below) & open[i] & ~reached_row[i];
+            reached_row[i] |= next[i];
+        }
+    }
+    std::swap(m_Frontier, m_Next);
+    m_NumSteps++;
+}
+
+int64_t GardenWalk::count_reachable() const
+{
+    return algo::accumulate(
+        m_Reached[m_NumSteps % 2],
+        [](int64_t sum, uint64_t word)
+        { return sum + std::popcount(word); },
+        int64_t{ 0 });
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+struct Vec2
+{
+    int64_t X;
+    int64_t Y;
+
+    auto operator<=>(const Vec2&) const = default;
+
+    Vec2 operator*(const int64_t& rhs) const
+    {
+        return Vec2{ X * rhs, Y * rhs };
+    }
+    Vec2 operator+(const Vec2& rhs) const
+    {
+        return Vec2{ X + rhs.X, Y + rhs.Y };
+    }
+    Vec2 operator-(const Vec2& rhs) const
+    {
+        return Vec2{ X - rhs.X, Y - rhs.Y };
+    }
+};
+
+// An infinite garden approximated by num_copies x num_copies copies of the actual garden, with the
+// walk starting in the center copy. Plots are kept as bitboards where every row is a run of 64-bit
+// words, so a step handles 64 plots at once
+class GardenWalk
+{
+  public:
+    GardenWalk(std::span<const std::string_view> garden, int64_t num_copies, Vec2 start);
+
+    int64_t num_steps() const
+    {
+        return m_NumSteps;
+    }
+
+    // A plot is reachable in exactly n steps if its distance has the parity of n and is at most n,
+    // so only plots that were never reached with this parity are new to the frontier
+    void step();
+    void step(int64_t n)
+    {
+        for (int64_t i = 0; i < n; i++)
+        {
+            step();
+        }
+    }
+
+    // Plots reachable in exactly num_steps() steps
+    int64_t count_reachable() const;
+
+  private:
+    uint64_t* row(std::vector<uint64_t>& board, size_t y) const
+    {
+        return board.data() + y * m_WordsPerRow;
+    }
+    const uint64_t* row(const std::vector<uint64_t>& board, size_t y) const
+    {
+        return board.data() + y * m_WordsPerRow;
+    }
+    void set(std::vector<uint64_t>& board, int64_t x, int64_t y) const
+    {
+        row(board, y)[x / 64] |= uint64_t{ 1 } << (x % 64);
+    }
+
+    Vec2 m_TileSize;
+    int64_t m_Width;
+    int64_t m_Height;
+    size_t m_WordsPerRow;
+    std::vector<uint64_t> m_Open;
+    std::array<std::vector<uint64_t>, 2> m_Reached;
+    std::vector<uint64_t> m_Frontier;
+    std::vector<uint64_t> m_Next;
+    int64_t m_NumSteps{ 0 };
+};
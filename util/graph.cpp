@@ -0,0 +1,86 @@
+#include "graph.h"
+
+uint32_t GraphBuilder::intern(std::string_view name)
+{
+    const auto [it, inserted]{ m_Graph.m_Ids.try_emplace(name, m_Graph.num_nodes()) };
+    if (inserted)
+    {
+        m_Graph.m_Names.push_back(name);
+    }
+    return it->second;
+}
+
+Graph GraphBuilder::build() &&
+{
+    Graph& graph{ m_Graph };
+
+    // First count the edges of each node to find where its range starts, then place them
+    graph.m_Offsets.assign(graph.num_nodes() + 1, 0);
+    for (const auto& [from, to, undirected] : m_Edges)
+    {
+        graph.m_Offsets[from + 1]++;
+        if (undirected)
+        {
+            graph.m_Offsets[to + 1]++;
+        }
+    }
+    for (uint32_t node = 0; node < graph.num_nodes(); node++)
+    {
+        graph.m_Offsets[node + 1] += graph.m_Offsets[node];
+    }
+
+    std::vector<uint32_t> next_edge(graph.m_Offsets.begin(), graph.m_Offsets.end() - 1);
+    graph.m_Targets.resize(graph.m_Offsets.back());
+    graph.m_Reverse.resize(graph.m_Offsets.back(), Graph::c_NoEdge);
+    for (const auto& [from, to, undirected] : m_Edges)
+    {
+        const uint32_t forward{ next_edge[from]++ };
+        graph.m_Targets[forward] = to;
+        if (undirected)
+        {
+            const uint32_t backward{ next_edge[to]++ };
+            graph.m_Targets[backward] = from;
+            graph.m_Reverse[forward] = backward;
+            graph.m_Reverse[backward] = forward;
+        }
+    }
+
+    m_Edges.clear();
+    return std::move(graph);
+}
+
+namespace algo
+{
+size_t count_components(const Graph& graph)
+{
+    NodeSet visited{ graph.num_nodes() };
+    std::vector<uint32_t> to_visit;
+
+    size_t num_components{ 0 };
+    for (uint32_t start = 0; start < graph.num_nodes(); start++)
+    {
+        if (visited.contains(start))
+        {
+            continue;
+        }
+
+        num_components++;
+        visited.insert(start);
+        to_visit.assign(1, start);
+        while (!to_visit.empty())
+        {
+            const uint32_t node{ to_visit.back() };
+            to_visit.pop_back();
+            for (const uint32_t target : graph.neighbours(node))
+            {
+                if (!visited.contains(target))
+                {
+                    visited.insert(target);
+                    to_visit.push_back(target);
+                }
+            }
+        }
+    }
+    return num_components;
+}
+} // namespace algo
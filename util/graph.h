@@ -0,0 +1,222 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "flat_map.h"
+
+// A set of node ids as one bit per node
+class NodeSet
+{
+  public:
+    explicit NodeSet(uint32_t num_nodes)
+        : m_Words((num_nodes + 63) / 64, 0)
+    {
+    }
+
+    bool contains(uint32_t node) const
+    {
+        return (m_Words[node / 64] & (uint64_t{ 1 } << (node % 64))) != 0;
+    }
+    void insert(uint32_t node)
+    {
+        m_Words[node / 64] |= uint64_t{ 1 } << (node % 64);
+    }
+    size_t size() const
+    {
+        size_t size{ 0 };
+        for (const uint64_t word : m_Words)
+        {
+            size += static_cast<size_t>(std::popcount(word));
+        }
+        return size;
+    }
+
+  private:
+    std::vector<uint64_t> m_Words;
+};
+
+// A graph of named nodes with dense ids, edges are stored in compressed sparse row form so the edges
+// leaving a node are a contiguous range of edge ids. Edges keep the order they were added in
+class Graph
+{
+  public:
+    static constexpr uint32_t c_NoEdge{ std::numeric_limits<uint32_t>::max() };
+
+    uint32_t num_nodes() const
+    {
+        return static_cast<uint32_t>(m_Names.size());
+    }
+    uint32_t num_edges() const
+    {
+        return static_cast<uint32_t>(m_Targets.size());
+    }
+
+    std::string_view name(uint32_t node) const
+    {
+        return m_Names[node];
+    }
+    std::optional<uint32_t> find(std::string_view name) const
+    {
+        const auto it{ m_Ids.find(name) };
+        return it != m_Ids.end() ? std::optional{ it->second } : std::nullopt;
+    }
+
+    uint32_t edges_begin(uint32_t node) const
+    {
+        return m_Offsets[node];
+    }
+    uint32_t edges_end(uint32_t node) const
+    {
+        return m_Offsets[node + 1];
+    }
+    uint32_t target(uint32_t edge) const
+    {
+        return m_Targets[edge];
+    }
+    // The edge going the opposite way for edges that were added as undirected, c_NoEdge otherwise
+    uint32_t reverse(uint32_t edge) const
+    {
+        return m_Reverse[edge];
+    }
+    std::span<const uint32_t> neighbours(uint32_t node) const
+    {
+        return std::span{ m_Targets }.subspan(m_Offsets[node], m_Offsets[node + 1] - m_Offsets[node]);
+    }
+
+  private:
+    friend class GraphBuilder;
+
+    FlatMap<std::string_view, uint32_t> m_Ids;
+    std::vector<std::string_view> m_Names;
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Targets;
+    std::vector<uint32_t> m_Reverse;
+};
+
+// Collects nodes and edges, the graph is only laid out once all edges are known. Names are not copied,
+// they have to outlive the graph
+class GraphBuilder
+{
+  public:
+    uint32_t intern(std::string_view name);
+
+    void add_edge(uint32_t from, uint32_t to)
+    {
+        m_Edges.push_back({ from, to, false });
+    }
+    void add_undirected_edge(uint32_t lhs, uint32_t rhs)
+    {
+        m_Edges.push_back({ lhs, rhs, true });
+    }
+
+    Graph build() &&;
+
+  private:
+    struct PendingEdge
+    {
+        uint32_t From;
+        uint32_t To;
+        bool Undirected;
+    };
+
+    Graph m_Graph;
+    std::vector<PendingEdge> m_Edges;
+};
+
+namespace algo
+{
+// Visits every node reachable from start in breadth-first order, only following edges that
+// follow_edge(edge) accepts. on_visit(node, edge) is called with the edge a node was reached through,
+// c_NoEdge for start, and stops the search by returning false. Returns all visited nodes
+template<class FollowEdgeT, class OnVisitT>
+NodeSet breadth_first_search(const Graph& graph, uint32_t start, FollowEdgeT&& follow_edge, OnVisitT&& on_visit)
+{
+    NodeSet visited{ graph.num_nodes() };
+    visited.insert(start);
+    if (!on_visit(start, Graph::c_NoEdge))
+    {
+        return visited;
+    }
+
+    std::vector<uint32_t> to_visit{ start };
+    for (size_t i = 0; i < to_visit.size(); i++)
+    {
+        const uint32_t node{ to_visit[i] };
+        for (uint32_t edge = graph.edges_begin(node); edge < graph.edges_end(node); edge++)
+        {
+            const uint32_t target{ graph.target(edge) };
+            if (visited.contains(target) || !follow_edge(edge))
+            {
+                continue;
+            }
+
+            visited.insert(target);
+            if (!on_visit(target, edge))
+            {
+                return visited;
+            }
+            to_visit.push_back(target);
+        }
+    }
+    return visited;
+}
+inline NodeSet breadth_first_search(const Graph& graph, uint32_t start)
+{
+    return breadth_first_search(
+        graph, start, [](uint32_t)
+        { return true; },
+        [](uint32_t, uint32_t)
+        { return true; });
+}
+
+// Same as breadth_first_search but in depth-first order
+template<class FollowEdgeT, class OnVisitT>
+NodeSet depth_first_search(const Graph& graph, uint32_t start, FollowEdgeT&& follow_edge, OnVisitT&& on_visit)
+{
+    NodeSet visited{ graph.num_nodes() };
+    std::vector<std::pair<uint32_t, uint32_t>> to_visit{ { start, Graph::c_NoEdge } };
+    while (!to_visit.empty())
+    {
+        const auto [node, via_edge]{ to_visit.back() };
+        to_visit.pop_back();
+        if (visited.contains(node))
+        {
+            continue;
+        }
+
+        visited.insert(node);
+        if (!on_visit(node, via_edge))
+        {
+            return visited;
+        }
+
+        for (uint32_t edge = graph.edges_end(node); edge-- > graph.edges_begin(node);)
+        {
+            if (!visited.contains(graph.target(edge)) && follow_edge(edge))
+            {
+                to_visit.push_back({ graph.target(edge), edge });
+            }
+        }
+    }
+    return visited;
+}
+inline NodeSet depth_first_search(const Graph& graph, uint32_t start)
+{
+    return depth_first_search(
+        graph, start, [](uint32_t)
+        { return true; },
+        [](uint32_t, uint32_t)
+        { return true; });
+}
+
+// Number of connected components, every edge has to be added in both directions, e.g. through
+// GraphBuilder::add_undirected_edge
+size_t count_components(const Graph& graph);
+} // namespace algo
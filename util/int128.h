@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Compilers that have a builtin 128 bit integer use it, MSVC only has the undocumented std::_Signed128 from an
+// internal header so it gets a small two's complement replacement instead. Define AOC_PORTABLE_INT128 to
+// force the replacement elsewhere, e.g. to test it
+#if defined(__SIZEOF_INT128__) && !defined(AOC_PORTABLE_INT128)
+__extension__ typedef __int128 int128_t;
+#else
+class Int128
+{
+  public:
+    constexpr Int128() = default;
+    template<std::integral T>
+    constexpr Int128(T value)
+        : m_Low{ static_cast<uint64_t>(value) }
+    {
+        if constexpr (std::signed_integral<T>)
+        {
+            m_High = value < 0 ? ~uint64_t{ 0 } : 0;
+        }
+    }
+
+    // Truncates like a conversion between builtin integers
+    template<std::integral T>
+        requires(!std::same_as<T, bool>)
+    explicit constexpr operator T() const
+    {
+        return static_cast<T>(m_Low);
+    }
+    explicit constexpr operator bool() const
+    {
+        return (m_Low | m_High) != 0;
+    }
+
+    friend constexpr bool operator==(const Int128& lhs, const Int128& rhs) = default;
+    friend constexpr std::strong_ordering operator<=>(const Int128& lhs, const Int128& rhs)
+    {
+        if (lhs.m_High != rhs.m_High)
+        {
+            return static_cast<int64_t>(lhs.m_High) <=> static_cast<int64_t>(rhs.m_High);
+        }
+        return lhs.m_Low <=> rhs.m_Low;
+    }
+
+    constexpr Int128 operator-() const
+    {
+        return Int128{ 0 } - *this;
+    }
+
+    friend constexpr Int128 operator+(const Int128& lhs, const Int128& rhs)
+    {
+        const uint64_t low{ lhs.m_Low + rhs.m_Low };
+        const uint64_t carry{ low < lhs.m_Low ? 1u : 0u };
+        return from_words(low, lhs.m_High + rhs.m_High + carry);
+    }
+    friend constexpr Int128 operator-(const Int128& lhs, const Int128& rhs)
+    {
+        const uint64_t borrow{ lhs.m_Low < rhs.m_Low ? 1u : 0u };
+        return from_words(lhs.m_Low - rhs.m_Low, lhs.m_High - rhs.m_High - borrow);
+    }
+    friend constexpr Int128 operator*(const Int128& lhs, const Int128& rhs)
+    {
+        // Only the low 128 bits of the product are kept, those are the same for signed and unsigned operands
+        const Int128 low_product{ multiply_words(lhs.m_Low, rhs.m_Low) };
+        return from_words(low_product.m_Low, low_product.m_High + lhs.m_Low * rhs.m_High + lhs.m_High * rhs.m_Low);
+    }
+    // Rounds towards zero and the remainder takes the sign of lhs, same as for builtin integers
+    friend constexpr Int128 operator/(const Int128& lhs, const Int128& rhs)
+    {
+        return divide(lhs, rhs).first;
+    }
+    friend constexpr Int128 operator%(const Int128& lhs, const Int128& rhs)
+    {
+        return divide(lhs, rhs).second;
+    }
+
+    constexpr Int128& operator+=(const Int128& rhs)
+    {
+        return *this = *this + rhs;
+    }
+    constexpr Int128& operator-=(const Int128& rhs)
+    {
+        return *this = *this - rhs;
+    }
+    constexpr Int128& operator*=(const Int128& rhs)
+    {
+        return *this = *this * rhs;
+    }
+    constexpr Int128& operator/=(const Int128& rhs)
+    {
+        return *this = *this / rhs;
+    }
+    constexpr Int128& operator%=(const Int128& rhs)
+    {
+        return *this = *this % rhs;
+    }
+
+  private:
+    static constexpr Int128 from_words(uint64_t low, uint64_t high)
+    {
+        Int128 value{};
+        value.m_Low = low;
+        value.m_High = high;
+        return value;
+    }
+
+    constexpr bool is_negative() const
+    {
+        return static_cast<int64_t>(m_High) < 0;
+    }
+    constexpr bool fits_int64() const
+    {
+        return m_High == (static_cast<int64_t>(m_Low) < 0 ? ~uint64_t{ 0 } : 0);
+    }
+
+    static constexpr Int128 multiply_words(uint64_t lhs, uint64_t rhs)
+    {
+        const uint64_t lhs_low{ lhs & 0xFFFFFFFF };
+        const uint64_t lhs_high{ lhs >> 32 };
+        const uint64_t rhs_low{ rhs & 0xFFFFFFFF };
+        const uint64_t rhs_high{ rhs >> 32 };
+
+        const uint64_t low_low{ lhs_low * rhs_low };
+        const uint64_t high_low{ lhs_high * rhs_low };
+        const uint64_t low_high{ lhs_low * rhs_high };
+        const uint64_t high_high{ lhs_high * rhs_high };
+
+        const uint64_t middle{ (low_low >> 32) + (high_low & 0xFFFFFFFF) + (low_high & 0xFFFFFFFF) };
+        return from_words((middle << 32) | (low_low & 0xFFFFFFFF),
+                          high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32));
+    }
+
+    static constexpr std::pair<Int128, Int128> divide(const Int128& lhs, const Int128& rhs)
+    {
+        // Almost all divisions happen on values that would fit into 64 bits, leave those to the hardware
+        const bool overflows{ lhs == Int128{ INT64_MIN } && rhs == Int128{ -1 } };
+        if (lhs.fits_int64() && rhs.fits_int64() && !overflows)
+        {
+            const int64_t lhs_value{ static_cast<int64_t>(lhs.m_Low) };
+            const int64_t rhs_value{ static_cast<int64_t>(rhs.m_Low) };
+            return { Int128{ lhs_value / rhs_value }, Int128{ lhs_value % rhs_value } };
+        }
+
+        // Otherwise long division on the magnitudes, one bit at a time
+        const Int128 dividend{ lhs.is_negative() ? -lhs : lhs };
+        const Int128 divisor{ rhs.is_negative() ? -rhs : rhs };
+        Int128 quotient{};
+        Int128 remainder{};
+        for (int bit = 127; bit >= 0; bit--)
+        {
+            const uint64_t dividend_bit{ ((bit >= 64 ? dividend.m_High : dividend.m_Low) >> (bit % 64)) & 1 };
+            remainder = from_words((remainder.m_Low << 1) | dividend_bit, (remainder.m_High << 1) | (remainder.m_Low >> 63));
+            if (!remainder.less_unsigned(divisor))
+            {
+                remainder = remainder - divisor;
+                (bit >= 64 ? quotient.m_High : quotient.m_Low) |= uint64_t{ 1 } << (bit % 64);
+            }
+        }
+
+        return {
+            lhs.is_negative() != rhs.is_negative() ? -quotient : quotient,
+            lhs.is_negative() ? -remainder : remainder,
+        };
+    }
+    constexpr bool less_unsigned(const Int128& rhs) const
+    {
+        return m_High != rhs.m_High ? m_High < rhs.m_High : m_Low < rhs.m_Low;
+    }
+
+    uint64_t m_Low{ 0 };
+    uint64_t m_High{ 0 };
+};
+using int128_t = Int128;
+#endif
+
+namespace algo
+{
+// Neither fmt nor std know how to print the replacement type, so roll our own
+inline std::string to_string(int128_t value)
+{
+    if (value == 0)
+    {
+        return "0";
+    }
+
+    const bool negative{ value < 0 };
+    std::string str;
+    while (value != 0)
+    {
+        const int digit{ static_cast<int>(value % 10) };
+        str.push_back(static_cast<char>('0' + (negative ? -digit : digit)));
+        value /= 10;
+    }
+    if (negative)
+    {
+        str.push_back('-');
+    }
+    std::reverse(str.begin(), str.end());
+    return str;
+}
+} // namespace algo
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Half open interval [Begin, End)
+template<class T>
+struct Interval
+{
+    T Begin;
+    T End;
+
+    constexpr bool empty() const
+    {
+        return !(Begin < End);
+    }
+    constexpr T size() const
+    {
+        return empty() ? T{ 0 } : End - Begin;
+    }
+    constexpr bool contains(const T& value) const
+    {
+        return !(value < Begin) && value < End;
+    }
+
+    constexpr Interval intersect(const Interval& rhs) const
+    {
+        return Interval{ std::max(Begin, rhs.Begin), std::min(End, rhs.End) };
+    }
+    // Parts of the interval below at and from at on, either of them may be empty
+    constexpr std::pair<Interval, Interval> split(const T& at) const
+    {
+        const T clamped{ std::clamp(at, Begin, std::max(Begin, End)) };
+        return { Interval{ Begin, clamped }, Interval{ clamped, End } };
+    }
+
+    constexpr bool operator==(const Interval& rhs) const = default;
+};
+
+// Union of intervals kept sorted, disjoint and with touching intervals coalesced, so that all set operations
+// are a single merge over both operands
+template<class T>
+class IntervalSet
+{
+  public:
+    using value_type = Interval<T>;
+    using const_iterator = typename std::vector<Interval<T>>::const_iterator;
+
+    IntervalSet() = default;
+    IntervalSet(Interval<T> interval)
+    {
+        if (!interval.empty())
+        {
+            m_Intervals.push_back(interval);
+        }
+    }
+    // Intervals may come in any order and overlap, they are sorted and coalesced once
+    template<std::ranges::input_range RangeT>
+    IntervalSet(std::from_range_t, RangeT&& range)
+    {
+        std::vector<Interval<T>> intervals{};
+        for (const Interval<T>& interval : range)
+        {
+            if (!interval.empty())
+            {
+                intervals.push_back(interval);
+            }
+        }
+        std::ranges::sort(intervals, {}, &Interval<T>::Begin);
+
+        m_Intervals.reserve(intervals.size());
+        for (const Interval<T>& interval : intervals)
+        {
+            append(interval);
+        }
+    }
+    IntervalSet(std::initializer_list<Interval<T>> intervals)
+        : IntervalSet(std::from_range, intervals)
+    {
+    }
+
+    const_iterator begin() const
+    {
+        return m_Intervals.begin();
+    }
+    const_iterator end() const
+    {
+        return m_Intervals.end();
+    }
+    size_t size() const
+    {
+        return m_Intervals.size();
+    }
+    bool empty() const
+    {
+        return m_Intervals.empty();
+    }
+    const Interval<T>& front() const
+    {
+        return m_Intervals.front();
+    }
+    const Interval<T>& back() const
+    {
+        return m_Intervals.back();
+    }
+
+    // Number of values in the set
+    T total_size() const
+    {
+        T total{ 0 };
+        for (const Interval<T>& interval : m_Intervals)
+        {
+            total += interval.size();
+        }
+        return total;
+    }
+    bool contains(const T& value) const
+    {
+        const auto it{ std::ranges::upper_bound(m_Intervals, value, {}, &Interval<T>::Begin) };
+        return it != m_Intervals.begin() && std::prev(it)->contains(value);
+    }
+
+    // Moves every interval by offset, unsigned offsets wrap around so they can move intervals down as well
+    IntervalSet shifted(const T& offset) const
+    {
+        IntervalSet result{};
+        result.m_Intervals.reserve(size());
+        for (const Interval<T>& interval : m_Intervals)
+        {
+            result.m_Intervals.push_back(Interval<T>{ static_cast<T>(interval.Begin + offset), static_cast<T>(interval.End + offset) });
+        }
+        return result;
+    }
+
+    friend IntervalSet operator|(const IntervalSet& lhs, const IntervalSet& rhs)
+    {
+        IntervalSet result{};
+        result.m_Intervals.reserve(lhs.size() + rhs.size());
+        auto lhs_it{ lhs.begin() };
+        auto rhs_it{ rhs.begin() };
+        while (lhs_it != lhs.end() || rhs_it != rhs.end())
+        {
+            const bool take_lhs{ rhs_it == rhs.end() || (lhs_it != lhs.end() && lhs_it->Begin < rhs_it->Begin) };
+            result.append(*(take_lhs ? lhs_it++ : rhs_it++));
+        }
+        return result;
+    }
+    friend IntervalSet operator&(const IntervalSet& lhs, const IntervalSet& rhs)
+    {
+        // Neither operand has touching intervals, so neither do the overlaps
+        IntervalSet result{};
+        auto lhs_it{ lhs.begin() };
+        auto rhs_it{ rhs.begin() };
+        while (lhs_it != lhs.end() && rhs_it != rhs.end())
+        {
+            const Interval<T> overlap{ lhs_it->intersect(*rhs_it) };
+            if (!overlap.empty())
+            {
+                result.m_Intervals.push_back(overlap);
+            }
+
+            if (lhs_it->End < rhs_it->End)
+            {
+                ++lhs_it;
+            }
+            else
+            {
+                ++rhs_it;
+            }
+        }
+        return result;
+    }
+    // Binary searches for the first overlapping interval, so it only costs the size of the result
+    friend IntervalSet operator&(const IntervalSet& lhs, const Interval<T>& rhs)
+    {
+        IntervalSet result{};
+        auto it{ std::ranges::upper_bound(lhs.m_Intervals, rhs.Begin, {}, &Interval<T>::End) };
+        for (; it != lhs.end() && it->Begin < rhs.End; ++it)
+        {
+            const Interval<T> overlap{ it->intersect(rhs) };
+            if (!overlap.empty())
+            {
+                result.m_Intervals.push_back(overlap);
+            }
+        }
+        return result;
+    }
+    friend IntervalSet operator-(const IntervalSet& lhs, const IntervalSet& rhs)
+    {
+        IntervalSet result{};
+        auto rhs_it{ rhs.begin() };
+        for (Interval<T> remaining : lhs)
+        {
+            while (rhs_it != rhs.end() && !(remaining.Begin < rhs_it->End))
+            {
+                ++rhs_it;
+            }
+
+            // The last cut may reach into the next interval of lhs, so it is not skipped yet
+            for (auto cut{ rhs_it }; cut != rhs.end() && cut->Begin < remaining.End; ++cut)
+            {
+                if (remaining.Begin < cut->Begin)
+                {
+                    result.m_Intervals.push_back(Interval<T>{ remaining.Begin, cut->Begin });
+                }
+                remaining.Begin = std::max(remaining.Begin, cut->End);
+            }
+
+            if (!remaining.empty())
+            {
+                result.m_Intervals.push_back(remaining);
+            }
+        }
+        return result;
+    }
+
+    bool operator==(const IntervalSet& rhs) const = default;
+
+  private:
+    // Appends an interval that does not begin before the last one, merging it into the last one if they touch
+    void append(const Interval<T>& interval)
+    {
+        if (!m_Intervals.empty() && !(m_Intervals.back().End < interval.Begin))
+        {
+            m_Intervals.back().End = std::max(m_Intervals.back().End, interval.End);
+        }
+        else
+        {
+            m_Intervals.push_back(interval);
+        }
+    }
+
+    std::vector<Interval<T>> m_Intervals;
+};
+
+// Axis aligned box in N dimensions, the product of one half open interval per dimension
+template<class T, size_t N>
+struct IntervalBox
+{
+    std::array<Interval<T>, N> Sides;
+
+    constexpr bool empty() const
+    {
+        return std::ranges::any_of(Sides, &Interval<T>::empty);
+    }
+    // Number of points in the box
+    constexpr T volume() const
+    {
+        T volume{ 1 };
+        for (const Interval<T>& side : Sides)
+        {
+            volume *= side.size();
+        }
+        return volume;
+    }
+
+    constexpr IntervalBox intersect(const IntervalBox& rhs) const
+    {
+        IntervalBox result{};
+        for (size_t i = 0; i < N; i++)
+        {
+            result.Sides[i] = Sides[i].intersect(rhs.Sides[i]);
+        }
+        return result;
+    }
+    // Parts of the box below at and from at on along dimension dim, either of them may be empty
+    constexpr std::pair<IntervalBox, IntervalBox> split(size_t dim, const T& at) const
+    {
+        std::pair<IntervalBox, IntervalBox> result{ *this, *this };
+        std::tie(result.first.Sides[dim], result.second.Sides[dim]) = Sides[dim].split(at);
+        return result;
+    }
+
+    constexpr bool operator==(const IntervalBox& rhs) const = default;
+};
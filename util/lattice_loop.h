@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+#include "int128.h"
+
+// Closed loop of axis aligned moves on the integer lattice, fed one move at a time. The shoelace formula
+// gives the enclosed area and Pick's theorem turns that plus the number of boundary points into the number
+// of lattice points, so no vertices need to be stored
+class LatticeLoop
+{
+  public:
+    // Moves distance steps along the unit direction (dx, dy)
+    void move(int64_t dx, int64_t dy, int64_t distance)
+    {
+        const int64_t next_x{ m_X + dx * distance };
+        const int64_t next_y{ m_Y + dy * distance };
+        m_DoubleArea += int128_t{ m_X } * int128_t{ next_y } - int128_t{ next_x } * int128_t{ m_Y };
+        m_Boundary += distance;
+        m_X = next_x;
+        m_Y = next_y;
+    }
+
+    // Lattice points inside of or on the loop, only meaningful once the loop is back at its start
+    int128_t num_points() const
+    {
+        const int128_t double_area{ m_DoubleArea < 0 ? -m_DoubleArea : m_DoubleArea };
+        return double_area / 2 + m_Boundary / 2 + 1;
+    }
+
+  private:
+    int64_t m_X{ 0 };
+    int64_t m_Y{ 0 };
+    int128_t m_DoubleArea{ 0 };
+    int128_t m_Boundary{ 0 };
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "flat_map.h"
+
+// Caches results in a FlatMap, for keys that are spread out too far to index an array with
+template<class KeyT, class ResultT>
+class MemoMap
+{
+  public:
+    using key_type = KeyT;
+    using result_type = ResultT;
+
+    const ResultT* find(const KeyT& key) const
+    {
+        const auto it{ m_Results.find(key) };
+        return it != m_Results.end() ? &it->second : nullptr;
+    }
+    void insert(const KeyT& key, ResultT result)
+    {
+        m_Results.try_emplace(key, std::move(result));
+    }
+
+    // Forgets all results but keeps the memory around for the next input
+    void reset()
+    {
+        m_Results.clear();
+    }
+
+  private:
+    FlatMap<KeyT, ResultT> m_Results;
+};
+
+// Caches results in an array indexed by the key, for keys that are known to be below some bound
+template<class ResultT>
+class MemoArray
+{
+  public:
+    using key_type = size_t;
+    using result_type = ResultT;
+
+    const ResultT* find(size_t key) const
+    {
+        return m_Known[key] ? &m_Results[key] : nullptr;
+    }
+    void insert(size_t key, ResultT result)
+    {
+        m_Results[key] = std::move(result);
+        m_Known[key] = true;
+    }
+
+    // Forgets all results and makes room for keys below size, only allocates when size grows
+    void reset(size_t size)
+    {
+        m_Known.assign(size, false);
+        if (m_Results.size() < size)
+        {
+            m_Results.resize(size);
+        }
+    }
+
+  private:
+    std::vector<bool> m_Known;
+    std::vector<ResultT> m_Results;
+};
+
+// Wraps a recursive lambda declared as [](this const auto& self, ...), the wrapper derives from the lambda so
+// self is deduced to be the wrapper and every recursive call goes through the cache. project(args...) maps the
+// arguments of a call to its key in StorageT
+template<class FunT, class ProjectT, class StorageT>
+class Memoized : public FunT
+{
+  public:
+    using ResultT = typename StorageT::result_type;
+
+    Memoized(FunT fun, ProjectT project, StorageT storage)
+        : FunT{ std::move(fun) }
+        , m_Project{ std::move(project) }
+        , m_Storage{ std::move(storage) }
+    {
+    }
+
+    template<class... ArgsT>
+    ResultT operator()(ArgsT&&... args) const
+    {
+        const typename StorageT::key_type key{ m_Project(std::as_const(args)...) };
+        if (const ResultT* result{ m_Storage.find(key) })
+        {
+            return *result;
+        }
+
+        ResultT result{ FunT::operator()(std::forward<ArgsT>(args)...) };
+        m_Storage.insert(key, result);
+        return result;
+    }
+
+    StorageT& storage()
+    {
+        return m_Storage;
+    }
+
+  private:
+    ProjectT m_Project;
+    mutable StorageT m_Storage;
+};
+
+namespace algo
+{
+template<class FunT, class ProjectT, class StorageT>
+Memoized<FunT, ProjectT, StorageT> memoize(FunT fun, ProjectT project, StorageT storage)
+{
+    return Memoized<FunT, ProjectT, StorageT>{ std::move(fun), std::move(project), std::move(storage) };
+}
+} // namespace algo
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Task queues of all threads running a parallel_for_each, a task that is running can check whether any
+// thread ran out of work and hand it part of its own work instead
+template<class TaskT>
+class TaskSplitter
+{
+  public:
+    explicit TaskSplitter(size_t num_threads)
+        : m_Queues(num_threads)
+    {
+    }
+
+    // True if some thread is idle and the queue of thread has nothing left for it to steal
+    bool wants_tasks(size_t thread)
+    {
+        if (m_NumIdle.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+        std::lock_guard lock{ m_Queues[thread].Mutex };
+        return m_Queues[thread].Tasks.empty();
+    }
+    void spawn(size_t thread, TaskT task)
+    {
+        m_NumPending.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard lock{ m_Queues[thread].Mutex };
+        m_Queues[thread].Tasks.push_back(std::move(task));
+    }
+
+    // Tasks are dealt out to one queue per thread up front
+    void deal(std::vector<TaskT> tasks)
+    {
+        m_NumPending.fetch_add(tasks.size(), std::memory_order_relaxed);
+        for (size_t i = 0; i < tasks.size(); i++)
+        {
+            m_Queues[i % m_Queues.size()].Tasks.push_back(std::move(tasks[i]));
+        }
+    }
+
+    // Runs tasks of thread until all tasks, including spawned ones, are done. A thread takes tasks from the
+    // front of its own queue and, once that is empty, steals from the back of the other queues
+    template<class FunT>
+    void run(size_t thread, FunT& fun)
+    {
+        bool idle{ false };
+        while (m_NumPending.load(std::memory_order_acquire) != 0)
+        {
+            std::optional<TaskT> task{ pop_task(thread) };
+            if (!task)
+            {
+                if (!std::exchange(idle, true))
+                {
+                    m_NumIdle.fetch_add(1, std::memory_order_relaxed);
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (std::exchange(idle, false))
+            {
+                m_NumIdle.fetch_sub(1, std::memory_order_relaxed);
+            }
+            fun(std::move(task.value()));
+            m_NumPending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+  private:
+    std::optional<TaskT> pop_task(size_t thread)
+    {
+        const size_t num_threads{ m_Queues.size() };
+        for (size_t i = 0; i < num_threads; i++)
+        {
+            TaskQueue& queue{ m_Queues[(thread + i) % num_threads] };
+            std::lock_guard lock{ queue.Mutex };
+            if (queue.Tasks.empty())
+            {
+                continue;
+            }
+
+            const bool own_queue{ i == 0 };
+            TaskT task{ std::move(own_queue ? queue.Tasks.front() : queue.Tasks.back()) };
+            if (own_queue)
+            {
+                queue.Tasks.pop_front();
+            }
+            else
+            {
+                queue.Tasks.pop_back();
+            }
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    struct TaskQueue
+    {
+        std::mutex Mutex;
+        std::deque<TaskT> Tasks;
+    };
+    std::vector<TaskQueue> m_Queues;
+    std::atomic<size_t> m_NumPending{ 0 };
+    std::atomic<size_t> m_NumIdle{ 0 };
+};
+
+// Passed to tasks that split themselves, spawned tasks go to the queue of the thread running the task
+template<class TaskT>
+class TaskSpawner
+{
+  public:
+    TaskSpawner(TaskSplitter<TaskT>& splitter, size_t thread)
+        : m_Splitter{ splitter }
+        , m_Thread{ thread }
+    {
+    }
+
+    bool wants_tasks() const
+    {
+        return m_Splitter.wants_tasks(m_Thread);
+    }
+    void spawn(TaskT task) const
+    {
+        m_Splitter.spawn(m_Thread, std::move(task));
+    }
+
+  private:
+    TaskSplitter<TaskT>& m_Splitter;
+    size_t m_Thread;
+};
+
+namespace algo
+{
+// Calls fun for every task on all hardware threads, idle threads steal queued tasks from the others. If fun
+// also takes a TaskSpawner a running task can poll wants_tasks and spawn part of its remaining work, so
+// that a few large tasks don't leave the other threads without work
+template<class TaskT, class FunT>
+void parallel_for_each(std::vector<TaskT> tasks, FunT&& fun)
+{
+    const size_t num_threads{ std::max(size_t{ 1 }, static_cast<size_t>(std::thread::hardware_concurrency())) };
+
+    TaskSplitter<TaskT> splitter{ num_threads };
+    splitter.deal(std::move(tasks));
+
+    std::vector<std::jthread> threads;
+    for (size_t thread = 0; thread < num_threads; thread++)
+    {
+        threads.emplace_back(
+            [&, thread]()
+            {
+                const auto run_task = [&](TaskT task)
+                {
+                    if constexpr (std::invocable<FunT&, TaskT, const TaskSpawner<TaskT>&>)
+                    {
+                        fun(std::move(task), TaskSpawner<TaskT>{ splitter, thread });
+                    }
+                    else
+                    {
+                        fun(std::move(task));
+                    }
+                };
+                splitter.run(thread, run_task);
+            });
+    }
+}
+} // namespace algo
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "literal_string.h"
+
+// Collision free lookup of a fixed set of keys, a seed and table size that give every key its own slot
+// are searched for at compile time. Looking up a string costs one hash and one compare
+template<LiteralString... Keys>
+class PerfectHash
+{
+  public:
+    static constexpr size_t size()
+    {
+        return sizeof...(Keys);
+    }
+
+    // Index of str in Keys
+    static constexpr std::optional<size_t> find(std::string_view str)
+    {
+        const uint8_t index{ c_Slots[slot_of(str, c_Layout.Seed, c_Layout.Bits)] };
+        return index != c_Empty && c_Keys[index] == str ? std::optional{ size_t{ index } } : std::nullopt;
+    }
+    // Index of the key str starts with, trying shorter keys first
+    static constexpr std::optional<size_t> find_prefix(std::string_view str)
+    {
+        for (const size_t length : c_Lengths)
+        {
+            if (length <= str.size())
+            {
+                if (const std::optional<size_t> index{ find(str.substr(0, length)) })
+                {
+                    return index;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+    // Index of the key str ends with, trying shorter keys first
+    static constexpr std::optional<size_t> find_suffix(std::string_view str)
+    {
+        for (const size_t length : c_Lengths)
+        {
+            if (length <= str.size())
+            {
+                if (const std::optional<size_t> index{ find(str.substr(str.size() - length)) })
+                {
+                    return index;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+  private:
+    static_assert(size() > 0 && size() < 255, "PerfectHash needs between 1 and 254 keys");
+
+    static constexpr uint8_t c_Empty{ 255 };
+    static constexpr std::array<std::string_view, size()> c_Keys{ Keys.std_view()... };
+
+    static constexpr size_t slot_of(std::string_view str, uint64_t seed, size_t bits)
+    {
+        uint64_t hash{ 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull) };
+        for (const char c : str)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+        }
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+    }
+
+    struct Layout
+    {
+        uint64_t Seed;
+        size_t Bits;
+    };
+    // Starts with at least twice as many slots as keys, a few seeds are usually enough at that size
+    static consteval Layout find_layout()
+    {
+        constexpr uint64_t c_MaxSeeds{ 256 };
+        for (size_t bits = std::bit_width(2 * size() - 1); bits < 16; bits++)
+        {
+            for (uint64_t seed = 0; seed < c_MaxSeeds; seed++)
+            {
+                std::array<size_t, size()> slots{};
+                std::ranges::transform(c_Keys, slots.begin(), [&](std::string_view key)
+                                       { return slot_of(key, seed, bits); });
+                std::ranges::sort(slots);
+                if (std::ranges::adjacent_find(slots) == slots.end())
+                {
+                    return Layout{ seed, bits };
+                }
+            }
+        }
+        throw "No collision free layout, are there duplicate keys?";
+    }
+    static constexpr Layout c_Layout{ find_layout() };
+
+    static consteval auto make_slots()
+    {
+        std::array<uint8_t, size_t{ 1 } << c_Layout.Bits> slots{};
+        slots.fill(c_Empty);
+        for (size_t i = 0; i < size(); i++)
+        {
+            slots[slot_of(c_Keys[i], c_Layout.Seed, c_Layout.Bits)] = static_cast<uint8_t>(i);
+        }
+        return slots;
+    }
+    static constexpr auto c_Slots{ make_slots() };
+
+    // Distinct key lengths in ascending order, so prefixes and suffixes only need one lookup per length
+    static consteval auto make_lengths()
+    {
+        std::array<size_t, size()> lengths{ Keys.size... };
+        std::ranges::sort(lengths);
+        const auto num_lengths{ std::ranges::unique(lengths).begin() - lengths.begin() };
+        return std::pair{ lengths, static_cast<size_t>(num_lengths) };
+    }
+    static constexpr auto c_SortedLengths{ make_lengths() };
+    static constexpr std::span<const size_t> c_Lengths{ std::span{ c_SortedLengths.first }.first(c_SortedLengths.second) };
+};
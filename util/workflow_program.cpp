@@ -0,0 +1,99 @@
+#include "workflow_program.h"
+
+#include <ranges>
+
+#include "algorithms.h"
+#include "flat_map.h"
+#include "tokenize.h"
+
+namespace
+{
+struct WorkflowRule
+{
+    PartCategory Category;
+    bool LessThan; // otherwise greater than
+    int64_t Rating;
+    std::string_view NextWorkflow;
+};
+
+struct Workflow
+{
+    std::string_view Name;
+    std::vector<WorkflowRule> Rules;
+    std::string_view FinalRule;
+};
+
+WorkflowRule to_workflow_rule(std::string_view str)
+{
+    const std::vector parts{ algo::split<"<>:", TokenizeBehavior::AnyOfDelimiter>(str) };
+    return WorkflowRule{
+        algo::to_category(parts[0]),
+        str[1] == '<',
+        algo::stoi<int64_t>(parts[1]),
+        parts[2],
+    };
+}
+
+Workflow to_workflow(std::string_view str)
+{
+    const std::vector name_and_rules{ algo::split<'{'>(str) };
+    std::vector rules{ algo::split<','>(algo::trim(name_and_rules[1], '}')) };
+    const std::string_view final_rule{ rules.back() };
+    rules.pop_back();
+
+    return Workflow{
+        name_and_rules[0],
+        rules | std::views::transform(&to_workflow_rule) | std::ranges::to<std::vector>(),
+        final_rule,
+    };
+}
+} // namespace
+
+namespace algo
+{
+PartCategory to_category(std::string_view str)
+{
+    return static_cast<PartCategory>(CategoryNames::find(str).value());
+}
+
+Program compile_workflows(std::string_view workflows_str)
+{
+    const std::vector workflows{ algo::split<'\n'>(workflows_str) | std::views::transform(&to_workflow) | std::ranges::to<std::vector>() };
+
+    // Intern all workflow names, their id being the index of their first instruction
+    FlatMap<std::string_view, uint32_t> workflow_ids{
+        { "A", c_Accepted },
+        { "R", c_Rejected },
+    };
+    uint32_t num_instructions{ 0 };
+    for (const Workflow& workflow : workflows)
+    {
+        workflow_ids[workflow.Name] = num_instructions;
+        num_instructions += static_cast<uint32_t>(workflow.Rules.size() + 1);
+    }
+
+    Program program{};
+    program.Instructions.resize(num_instructions);
+    program.Entry = workflow_ids.at("in");
+    for (const Workflow& workflow : workflows)
+    {
+        Instruction* instruction{ &program.Instructions[workflow_ids.at(workflow.Name)] };
+        for (const WorkflowRule& rule : workflow.Rules)
+        {
+            *instruction++ = Instruction{
+                rule.Category,
+                rule.LessThan ? Operation::LessThan : Operation::GreaterThan,
+                rule.Rating,
+                workflow_ids.at(rule.NextWorkflow),
+            };
+        }
+        *instruction = Instruction{
+            PartCategory::Cool,
+            Operation::Always,
+            0,
+            workflow_ids.at(workflow.FinalRule),
+        };
+    }
+    return program;
+}
+} // namespace algo
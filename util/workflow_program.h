@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "perfect_hash.h"
+
+enum class PartCategory
+{
+    ExtremelyCoolLooking,
+    Musical,
+    Aerodynamic,
+    Shiny,
+    Count,
+
+    Cool = ExtremelyCoolLooking,
+    Dynamic = Aerodynamic,
+};
+
+// Names of all categories as they appear in the input, in the same order as PartCategory
+using CategoryNames = PerfectHash<"x", "m", "a", "s">;
+
+enum class Operation : uint8_t
+{
+    LessThan,
+    GreaterThan,
+    Always,
+};
+
+// Workflows compiled into a flat list of instructions, each one jumps directly to the first instruction of
+// its target workflow when its condition holds and falls through to the next one otherwise
+struct Instruction
+{
+    PartCategory Category;
+    Operation Op;
+    int64_t Rating;
+    uint32_t Jump;
+};
+
+inline constexpr uint32_t c_Accepted{ std::numeric_limits<uint32_t>::max() - 1 };
+inline constexpr uint32_t c_Rejected{ std::numeric_limits<uint32_t>::max() };
+
+struct Program
+{
+    std::vector<Instruction> Instructions;
+    uint32_t Entry;
+};
+
+namespace algo
+{
+PartCategory to_category(std::string_view str);
+
+// Compiles the workflows in the first paragraph of the input, one per line, starting at the one named "in"
+Program compile_workflows(std::string_view workflows);
+} // namespace algo